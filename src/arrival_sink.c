@@ -0,0 +1,108 @@
+#include "arrival_sink.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+static const char* lane_files[NUM_LANES] = {
+    "data/lanea.txt",
+    "data/laneb.txt",
+    "data/lanec.txt",
+    "data/laned.txt"
+};
+
+// Connect to the simulator; returns -1 if it is not running
+static int connectSimulator(const char* host, int port) {
+    char service[16];
+    snprintf(service, sizeof(service), "%d", port);
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    int err = getaddrinfo(host, service, &hints, &res);
+    if (err != 0) {
+        fprintf(stderr, "%s: %s, writing lane files only\n", host, gai_strerror(err));
+        return -1;
+    }
+    int sock = -1;
+    for (struct addrinfo* ai = res; ai != NULL && sock < 0; ai = ai->ai_next) {
+        sock = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (sock >= 0 && connect(sock, ai->ai_addr, ai->ai_addrlen) < 0) {
+            close(sock);
+            sock = -1;
+        }
+    }
+    freeaddrinfo(res);
+    if (sock < 0) perror("Connect failed, writing lane files only");
+    return sock;
+}
+
+// Write all of buf; 1 if the connection is gone. MSG_NOSIGNAL turns a
+// closed peer into EPIPE instead of killing the generator.
+static int sendAll(int sock, const unsigned char* buf, int len) {
+    int done = 0;
+    while (done < len) {
+        ssize_t n = send(sock, buf + done, len - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 1;
+        done += (int)n;
+    }
+    return 0;
+}
+
+// Connect to opts->host:opts->port, or open the lane files (emptying them
+// first if truncate). Returns 1 if neither works.
+int openArrivalSink(ArrivalSink* s, const ArrivalOptions* opts, int truncate) {
+    s->flush_ms = opts->flush_ms;
+    s->sock = connectSimulator(opts->host, opts->port);
+    if (s->sock >= 0) {
+        printf("Connected to simulator at %s:%d.\n", opts->host, opts->port);
+        return 0;
+    }
+    return openLaneWriter(&s->lanes, lane_files, NUM_LANES, truncate, s->flush_ms);
+}
+
+// Deliver arrivals: binary frames over the socket, else the lane files.
+// Once the simulator has gone away, the frame that failed and everything
+// after it go to the lane files. Returns 1 on a lane file error.
+int arrivalSinkSend(ArrivalSink* s, const WireArrival* arrivals, int count) {
+    if (s->sock >= 0) {
+        int sent = 0;
+        while (sent < count) {
+            unsigned char frame[WIRE_MAX_FRAME];
+            int n = count - sent < WIRE_MAX_BATCH ? count - sent : WIRE_MAX_BATCH;
+            int len = wireEncodeFrame(frame, arrivals + sent, n);
+            if (sendAll(s->sock, frame, len)) break;
+            sent += n;
+        }
+        if (sent == count) return 0;
+        perror("Simulator connection lost, writing lane files");
+        close(s->sock);
+        s->sock = -1;
+        if (openLaneWriter(&s->lanes, lane_files, NUM_LANES, 0, s->flush_ms)) return 1;
+        arrivals += sent;
+        count -= sent;
+    }
+    for (int i = 0; i < count; i++) {
+        if (laneWriterAppend(&s->lanes, arrivals[i].lane, arrivals[i].id)) return 1;
+    }
+    return 0;
+}
+
+// Lane files only: flush if due before next_ms (see laneWriterFlushDue)
+int arrivalSinkFlushDue(ArrivalSink* s, unsigned int now_ms, unsigned int next_ms) {
+    return s->sock < 0 ? laneWriterFlushDue(&s->lanes, now_ms, next_ms) : 0;
+}
+
+// Lane files only: write out everything buffered
+int flushArrivalSink(ArrivalSink* s) {
+    return s->sock < 0 ? flushLaneWriter(&s->lanes) : 0;
+}
+
+void closeArrivalSink(ArrivalSink* s) {
+    if (s->sock >= 0) close(s->sock);
+    else closeLaneWriter(&s->lanes);
+    s->sock = -1;
+}
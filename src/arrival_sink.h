@@ -0,0 +1,30 @@
+#ifndef ARRIVAL_SINK_H
+#define ARRIVAL_SINK_H
+
+#include "wire.h"
+#include "arrivals.h"
+#include "lane_writer.h"
+
+// Where a traffic generator's arrivals go. Connected, the simulator gets
+// every arrival over the socket as binary frames and the lane files are
+// left alone (nothing would consume them). Otherwise, or once the
+// simulator goes away, the arrivals go to the lane files for
+// `simulator --files`.
+
+#define ARRIVAL_SINK_HOST "127.0.0.1"
+#define ARRIVAL_SINK_PORT 8080
+
+typedef struct {
+    int sock;                   // -1 while writing the lane files
+    LaneWriter lanes;
+    unsigned int flush_ms;
+} ArrivalSink;
+
+// Function prototypes
+int openArrivalSink(ArrivalSink* s, const ArrivalOptions* opts, int truncate);
+int arrivalSinkSend(ArrivalSink* s, const WireArrival* arrivals, int count);
+int arrivalSinkFlushDue(ArrivalSink* s, unsigned int now_ms, unsigned int next_ms);
+int flushArrivalSink(ArrivalSink* s);
+void closeArrivalSink(ArrivalSink* s);
+
+#endif // ARRIVAL_SINK_H
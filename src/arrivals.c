@@ -0,0 +1,298 @@
+#include "arrivals.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+static const char* model_names[ARRIVAL_MODEL_COUNT] = {
+    "poisson",
+    "mmpp",
+    "diurnal",
+    "trace"
+};
+
+// Relative traffic at each hour of the day: quiet night, morning and
+// evening commute peaks
+static const double default_profile[DIURNAL_POINTS] = {
+    0.25, 0.15, 0.10, 0.10, 0.15, 0.35, 0.90, 1.70, 2.00, 1.40, 1.10, 1.10,
+    1.20, 1.10, 1.10, 1.30, 1.70, 1.90, 1.50, 1.00, 0.80, 0.60, 0.45, 0.35
+};
+
+static uint64_t splitmix64(uint64_t* x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+void seedRng(Rng* r, uint64_t seed) {
+    for (int i = 0; i < 4; i++) r->s[i] = splitmix64(&seed);
+}
+
+uint64_t rngNext(Rng* r) {
+    uint64_t* s = r->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// Uniform in [0, 1) with 53 random bits
+double rngUniform(Rng* r) {
+    return (rngNext(r) >> 11) * 0x1.0p-53;
+}
+
+// Exponential gap for a process with the given rate (per unit time)
+double rngExponential(Rng* r, double rate) {
+    return -log(1.0 - rngUniform(r)) / rate;
+}
+
+// Same mean rate on every lane, default MMPP and diurnal shapes
+void defaultArrivalConfig(ArrivalConfig* cfg, ArrivalModel model, double rate_per_lane) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->model = model;
+    for (int l = 0; l < NUM_LANES; l++) cfg->rate[l] = rate_per_lane;
+    cfg->burst_factor = 5.0;
+    cfg->calm_s = 60.0;
+    cfg->burst_s = 10.0;
+    cfg->day_s = 86400.0;
+    memcpy(cfg->profile, default_profile, sizeof(default_profile));
+}
+
+// Rate multiplier at t_ms. Calls come in time order, so the MMPP state can
+// be walked forward as they arrive.
+static double modulation(ArrivalGen* g, double t_ms) {
+    const ArrivalConfig* c = &g->cfg;
+    switch (c->model) {
+        case ARRIVAL_MMPP:
+            while (t_ms >= g->state_end_ms) {
+                g->bursting = !g->bursting;
+                double mean_ms = (g->bursting ? c->burst_s : c->calm_s) * 1000.0;
+                g->state_end_ms += rngExponential(&g->rng, 1.0 / mean_ms);
+            }
+            return g->bursting ? c->burst_factor : 1.0;
+        case ARRIVAL_DIURNAL: {
+            double day_ms = c->day_s * 1000.0;
+            double pos = fmod(t_ms, day_ms) / day_ms * DIURNAL_POINTS;
+            int h = (int)pos;
+            double a = c->profile[h], b = c->profile[(h + 1) % DIURNAL_POINTS];
+            return (a + (b - a) * (pos - h)) / g->profile_mean;
+        }
+        default:
+            return 1.0;
+    }
+}
+
+void initArrivalGen(ArrivalGen* g, const ArrivalConfig* cfg, uint64_t seed, unsigned int first_id) {
+    memset(g, 0, sizeof(*g));
+    g->cfg = *cfg;
+    g->next_id = first_id;
+    seedRng(&g->rng, seed);
+
+    // Non-constant models are thinned: candidates come at the peak rate and
+    // each is kept with probability modulation / peak
+    g->peak = 1.0;
+    if (cfg->model == ARRIVAL_MMPP && cfg->burst_factor > 1.0) {
+        g->peak = cfg->burst_factor;
+        g->state_end_ms = rngExponential(&g->rng, 1.0 / (cfg->calm_s * 1000.0));
+    } else if (cfg->model == ARRIVAL_DIURNAL) {
+        double sum = 0, max = 0;
+        for (int h = 0; h < DIURNAL_POINTS; h++) {
+            sum += cfg->profile[h];
+            if (cfg->profile[h] > max) max = cfg->profile[h];
+        }
+        g->profile_mean = sum > 0 ? sum / DIURNAL_POINTS : 1.0;
+        g->peak = max / g->profile_mean;
+    }
+    for (int l = 0; l < NUM_LANES; l++) {
+        g->lambda[l] = cfg->rate[l] * g->peak / 1000.0;
+        g->next_ms[l] = g->lambda[l] > 0 ? rngExponential(&g->rng, g->lambda[l]) : HUGE_VAL;
+    }
+}
+
+// Produce the next arrival; returns 0 once a trace is used up (or no lane
+// has a rate)
+static int nextArrival(ArrivalGen* g, TimedArrival* out) {
+    if (g->cfg.model == ARRIVAL_TRACE) {
+        if (g->trace_pos >= g->cfg.trace_len) return 0;
+        *out = g->cfg.trace[g->trace_pos++];
+        out->arrival.id = g->next_id++;
+        return 1;
+    }
+    for (;;) {
+        int lane = 0;
+        for (int l = 1; l < NUM_LANES; l++) {
+            if (g->next_ms[l] < g->next_ms[lane]) lane = l;
+        }
+        double t = g->next_ms[lane];
+        if (t == HUGE_VAL || t >= 4294967295.0) return 0;
+        g->next_ms[lane] += rngExponential(&g->rng, g->lambda[lane]);
+        if (g->peak > 1.0 && rngUniform(&g->rng) * g->peak >= modulation(g, t)) continue;
+        out->at_ms = (unsigned int)t;
+        out->arrival.id = g->next_id++;
+        out->arrival.lane = (unsigned char)lane;
+        out->arrival.intent = 0;
+        return 1;
+    }
+}
+
+// Offset of the next arrival from the start, without consuming it
+int peekArrival(ArrivalGen* g, unsigned int* at_ms) {
+    if (!g->has_pending) {
+        if (!nextArrival(g, &g->pending)) return 0;
+        g->has_pending = 1;
+    }
+    *at_ms = g->pending.at_ms;
+    return 1;
+}
+
+// Copy out the arrivals due before until_ms, in time order (at most max)
+int takeArrivals(ArrivalGen* g, unsigned int until_ms, WireArrival* out, int max) {
+    int n = 0;
+    unsigned int at;
+    while (n < max && peekArrival(g, &at) && at < until_ms) {
+        out[n++] = g->pending.arrival;
+        g->has_pending = 0;
+    }
+    return n;
+}
+
+int arrivalModelFromName(const char* name) {
+    for (int m = 0; m < ARRIVAL_MODEL_COUNT; m++) {
+        if (strcmp(name, model_names[m]) == 0) return m;
+    }
+    return -1;
+}
+
+const char* arrivalModelName(ArrivalModel model) {
+    return model_names[model];
+}
+
+// Read a text trace, one "<offset_ms> <lane A-D>" per line, in time order.
+// Returns a malloc'd array, or NULL if the file cannot be read.
+TimedArrival* loadArrivalTrace(const char* path, int* count) {
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) return NULL;
+    int cap = 1024, n = 0;
+    TimedArrival* trace = (TimedArrival*)malloc(sizeof(TimedArrival) * cap);
+    if (trace == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    unsigned int at, last = 0;
+    char lane;
+    while (fscanf(fp, "%u %c", &at, &lane) == 2) {
+        if (lane < 'A' || lane >= 'A' + NUM_LANES || at < last) continue;
+        if (n == cap) {
+            cap *= 2;
+            trace = (TimedArrival*)realloc(trace, sizeof(TimedArrival) * cap);
+            if (trace == NULL) {
+                fprintf(stderr, "Memory allocation failed\n");
+                exit(1);
+            }
+        }
+        TimedArrival a = {at, {0, (unsigned char)(lane - 'A'), 0}};
+        trace[n++] = a;
+        last = at;
+    }
+    fclose(fp);
+    *count = n;
+    return trace;
+}
+
+// "0.5" for every lane, or "A,B,C,D" per lane (arrivals per second)
+static int parseRates(const char* spec, double rate[NUM_LANES]) {
+    double r[NUM_LANES];
+    int fields = sscanf(spec, "%lf,%lf,%lf,%lf", &r[0], &r[1], &r[2], &r[3]);
+    if (fields == 1) {
+        for (int l = 1; l < NUM_LANES; l++) r[l] = r[0];
+    } else if (fields != NUM_LANES) {
+        return 1;
+    }
+    for (int l = 0; l < NUM_LANES; l++) {
+        if (r[l] < 0) return 1;
+        rate[l] = r[l];
+    }
+    return 0;
+}
+
+void printArrivalUsage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [--model poisson|mmpp|diurnal|trace] [--rate R | --rate A,B,C,D] [--seed N]\n"
+            "          [--burst FACTOR:CALM_S:BURST_S] [--day SECONDS] [--trace FILE] [--flush-ms N]\n"
+            "          [--host HOST] [--port PORT]\n"
+            "  --rate    mean arrivals per second, for all lanes or per lane\n"
+            "  --seed    PRNG seed; the same seed replays the same arrivals\n"
+            "  --burst   mmpp: rate multiplier and mean calm / burst durations\n"
+            "  --day     diurnal: length of one simulated day (default 86400)\n"
+            "  --trace   replay \"<offset_ms> <lane>\" lines (implies --model trace)\n"
+            "  --flush-ms  write buffered lane file lines at least this often (0 = every vehicle)\n"
+            "  --host, --port  simulator to connect to (default 127.0.0.1 8080); lane files if none\n",
+            prog);
+}
+
+// Apply generator command-line options on top of the defaults already in
+// opts. Returns 1 on a bad option.
+int parseArrivalOptions(int argc, char* argv[], ArrivalOptions* opts) {
+    ArrivalConfig* c = &opts->cfg;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc) {
+            int m = arrivalModelFromName(argv[++i]);
+            if (m < 0) return 1;
+            c->model = (ArrivalModel)m;
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            if (parseRates(argv[++i], c->rate)) return 1;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            opts->seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--burst") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%lf:%lf:%lf", &c->burst_factor, &c->calm_s, &c->burst_s) != 3) return 1;
+            if (c->calm_s <= 0 || c->burst_s <= 0) return 1;
+        } else if (strcmp(argv[i], "--day") == 0 && i + 1 < argc) {
+            c->day_s = atof(argv[++i]);
+            if (c->day_s <= 0) return 1;
+        } else if (strcmp(argv[i], "--flush-ms") == 0 && i + 1 < argc) {
+            opts->flush_ms = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            opts->host = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            opts->port = atoi(argv[++i]);
+            if (opts->port <= 0 || opts->port > 65535) return 1;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            const char* path = argv[++i];
+            c->trace = loadArrivalTrace(path, &c->trace_len);
+            if (c->trace == NULL) {
+                perror(path);
+                return 1;
+            }
+            c->model = ARRIVAL_TRACE;
+        } else {
+            return 1;
+        }
+    }
+    if (c->model == ARRIVAL_TRACE && c->trace == NULL) return 1;
+    return 0;
+}
+
+// Sleep until at_ms after start (a CLOCK_MONOTONIC reading). Absolute
+// deadlines keep the schedule from drifting by the time spent between
+// sleeps, and wall-clock steps cannot stretch or skip it.
+void arrivalSleepUntil(const struct timespec* start, unsigned int at_ms) {
+    struct timespec due = *start;
+    due.tv_sec += at_ms / 1000;
+    due.tv_nsec += (long)(at_ms % 1000) * 1000000L;
+    if (due.tv_nsec >= 1000000000L) {
+        due.tv_sec++;
+        due.tv_nsec -= 1000000000L;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR) {}
+}
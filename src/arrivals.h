@@ -0,0 +1,92 @@
+#ifndef ARRIVALS_H
+#define ARRIVALS_H
+
+#include <stdint.h>
+#include <time.h>
+#include "wire.h"
+
+#ifndef NUM_LANES
+#define NUM_LANES 4
+#endif
+
+// Seeded arrival-process engine shared by the traffic generators. Every
+// lane is an independent process with its own mean rate; the lanes are
+// merged in time order. The same seed and config always give the same
+// arrivals, independent of wall-clock time.
+
+// xoshiro256** PRNG, seeded through splitmix64
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+typedef enum {
+    ARRIVAL_POISSON,   // exponential gaps at a constant rate
+    ARRIVAL_MMPP,      // two-state Markov-modulated Poisson: calm and burst
+    ARRIVAL_DIURNAL,   // rate follows an hourly profile over a (scaled) day
+    ARRIVAL_TRACE,     // replay recorded arrivals
+    ARRIVAL_MODEL_COUNT
+} ArrivalModel;
+
+#define DIURNAL_POINTS 24
+
+// A scheduled arrival: what goes to the simulator, and when it is due
+typedef struct {
+    unsigned int at_ms;         // offset from the generator's start
+    WireArrival arrival;
+} TimedArrival;
+
+typedef struct {
+    ArrivalModel model;
+    double rate[NUM_LANES];     // mean arrivals per second (calm rate for MMPP)
+    double burst_factor;        // MMPP: rate multiplier while bursting
+    double calm_s;              // MMPP: mean time in each state, seconds
+    double burst_s;
+    double day_s;               // diurnal: length of one simulated day
+    double profile[DIURNAL_POINTS];  // diurnal: relative rate at each hour
+    const TimedArrival* trace;  // trace: lanes and due times, in time order
+    int trace_len;
+} ArrivalConfig;
+
+typedef struct {
+    ArrivalConfig cfg;
+    Rng rng;
+    double next_ms[NUM_LANES];  // next candidate arrival on each lane
+    double lambda[NUM_LANES];   // candidate rate per ms (the model's peak rate)
+    double peak;                // peak / mean modulation, for thinning
+    double profile_mean;
+    int bursting;               // MMPP state
+    double state_end_ms;
+    int trace_pos;
+    unsigned int next_id;
+    int has_pending;
+    TimedArrival pending;
+} ArrivalGen;
+
+// Options shared by the generator command lines
+typedef struct {
+    ArrivalConfig cfg;
+    uint64_t seed;
+    unsigned int flush_ms;      // lane file flush interval (see lane_writer.h)
+    const char* host;           // simulator address (see arrival_sink.h)
+    int port;
+} ArrivalOptions;
+
+// Function prototypes
+void seedRng(Rng* r, uint64_t seed);
+uint64_t rngNext(Rng* r);
+double rngUniform(Rng* r);
+double rngExponential(Rng* r, double rate);
+
+void defaultArrivalConfig(ArrivalConfig* cfg, ArrivalModel model, double rate_per_lane);
+void initArrivalGen(ArrivalGen* g, const ArrivalConfig* cfg, uint64_t seed, unsigned int first_id);
+int peekArrival(ArrivalGen* g, unsigned int* at_ms);
+int takeArrivals(ArrivalGen* g, unsigned int until_ms, WireArrival* out, int max);
+
+int arrivalModelFromName(const char* name);
+const char* arrivalModelName(ArrivalModel model);
+TimedArrival* loadArrivalTrace(const char* path, int* count);
+int parseArrivalOptions(int argc, char* argv[], ArrivalOptions* opts);
+void printArrivalUsage(const char* prog);
+void arrivalSleepUntil(const struct timespec* start, unsigned int at_ms);
+
+#endif // ARRIVALS_H
@@ -0,0 +1,519 @@
+// Micro-benchmarks for the simulator's data structures.
+// Usage: ./bench [name]   (runs every benchmark when no name is given)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/file.h>
+#include <netinet/in.h>
+#include "queue.h"
+#include "spsc_queue.h"
+#include "mpmc_queue.h"
+#include "wire.h"
+#include "net_server.h"
+#include "grid.h"
+#include "intersection.h"
+#include "wait_stats.h"
+#include "arrivals.h"
+#include "lane_writer.h"
+#include "lane_ingest.h"
+#include "sim_log.h"
+
+#define BENCH_VEHICLES 10000000
+
+static double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char* name, long ops, double secs) {
+    printf("%-28s %10ld ops  %8.3f s  %8.2f M ops/s\n", name, ops, secs, ops / secs / 1e6);
+}
+
+// Steady state: one lane holding a small backlog, one in / one out
+static void bench_queue() {
+    Queue* q = createQueue();
+    long checksum = 0;
+    for (int i = 0; i < 64; i++) {
+        Vehicle v = {.id = i};
+        enqueue(q, v);
+    }
+    double t0 = now_sec();
+    for (int i = 0; i < BENCH_VEHICLES; i++) {
+        Vehicle v = {.id = i};
+        enqueue(q, v);
+        checksum += dequeue(q).id;
+    }
+    report("queue steady enqueue+dequeue", BENCH_VEHICLES, now_sec() - t0);
+
+    // Burst: fill the lane completely, then drain it (exercises growth)
+    freeQueue(q);
+    q = createQueue();
+    t0 = now_sec();
+    for (int i = 0; i < BENCH_VEHICLES; i++) {
+        Vehicle v = {.id = i};
+        enqueue(q, v);
+    }
+    while (!isEmpty(q)) checksum += dequeue(q).id;
+    report("queue burst fill+drain", BENCH_VEHICLES, now_sec() - t0);
+
+    freeQueue(q);
+    if (checksum == 42) printf("\n"); // keep the loops observable
+}
+
+// Same burst pattern moved through the batch API 64 vehicles at a time
+static void bench_queue_batch() {
+    Queue* q = createQueue();
+    Vehicle batch[64];
+    long checksum = 0;
+    double t0 = now_sec();
+    for (int i = 0; i < BENCH_VEHICLES; i += 64) {
+        for (int k = 0; k < 64; k++) batch[k].id = i + k;
+        enqueueBatch(q, batch, 64);
+    }
+    int n;
+    while ((n = dequeueBatch(q, batch, 64)) > 0) checksum += batch[n - 1].id;
+    report("queue batch fill+drain", BENCH_VEHICLES, now_sec() - t0);
+    freeQueue(q);
+    if (checksum == 42) printf("\n");
+}
+
+static void* spsc_producer(void* arg) {
+    SpscQueue* q = (SpscQueue*)arg;
+    for (int i = 0; i < BENCH_VEHICLES; i++) {
+        Vehicle v = {.id = i};
+        while (!spscEnqueue(q, v)) sched_yield();
+    }
+    return NULL;
+}
+
+// Generator thread -> scheduler thread handoff through one SPSC lane
+static void bench_spsc() {
+    SpscQueue* q = createSpscQueue(4096);
+    Vehicle batch[64];
+    long received = 0, checksum = 0;
+    pthread_t thread;
+    double t0 = now_sec();
+    pthread_create(&thread, NULL, spsc_producer, q);
+    while (received < BENCH_VEHICLES) {
+        int n = spscDequeueBatch(q, batch, 64);
+        if (n == 0) sched_yield();
+        for (int k = 0; k < n; k++) checksum += batch[k].id;
+        received += n;
+    }
+    pthread_join(thread, NULL);
+    report("spsc cross-thread handoff", BENCH_VEHICLES, now_sec() - t0);
+    freeSpscQueue(q);
+    if (checksum == 42) printf("\n");
+}
+
+#define MPMC_MAX_PRODUCERS 16
+#define MPMC_PER_RUN 4000000
+
+typedef struct {
+    MpmcQueue* q;
+    int count;
+} MpmcProducerArg;
+
+static void* mpmc_producer(void* arg) {
+    MpmcProducerArg* a = (MpmcProducerArg*)arg;
+    for (int i = 0; i < a->count; i++) {
+        Vehicle v = {.id = i};
+        while (!mpmcEnqueue(a->q, v)) sched_yield();
+    }
+    return NULL;
+}
+
+// Several generator threads feeding one lane, drained by the scheduler
+static void bench_mpmc() {
+    for (int producers = 1; producers <= MPMC_MAX_PRODUCERS; producers *= 2) {
+        MpmcQueue* q = createMpmcQueue(4096);
+        pthread_t threads[MPMC_MAX_PRODUCERS];
+        MpmcProducerArg args[MPMC_MAX_PRODUCERS];
+        int per_producer = MPMC_PER_RUN / producers;
+        long total = (long)per_producer * producers, received = 0;
+
+        double t0 = now_sec();
+        for (int p = 0; p < producers; p++) {
+            args[p].q = q;
+            args[p].count = per_producer;
+            pthread_create(&threads[p], NULL, mpmc_producer, &args[p]);
+        }
+        while (received < total) {
+            Vehicle v;
+            if (mpmcDequeue(q, &v)) received++;
+            else sched_yield();
+        }
+        for (int p = 0; p < producers; p++) pthread_join(threads[p], NULL);
+
+        char name[40];
+        snprintf(name, sizeof(name), "mpmc %2d producer(s)", producers);
+        report(name, total, now_sec() - t0);
+        freeMpmcQueue(q);
+    }
+}
+
+#define WIRE_ARRIVALS 4000000
+#define WIRE_SEND_BUFFER 65536
+
+typedef struct {
+    int port;
+    int binary;
+} WireSenderArg;
+
+static void write_all(int fd, const char* buf, int len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        buf += n;
+        len -= (int)n;
+    }
+}
+
+// Generator side: connect over loopback TCP, encode arrivals and write
+// them in large chunks
+static void* wire_sender(void* arg) {
+    WireSenderArg* a = (WireSenderArg*)arg;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(a->port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("wire bench connect");
+        exit(1);
+    }
+    static char out[WIRE_SEND_BUFFER + WIRE_MAX_FRAME];
+    int len = 0;
+    WireArrival batch[WIRE_MAX_BATCH];
+    for (int i = 0; i < WIRE_ARRIVALS; i += WIRE_MAX_BATCH) {
+        for (int k = 0; k < WIRE_MAX_BATCH; k++) {
+            WireArrival w = {(unsigned int)(i + k), (unsigned char)(k & 3), 0};
+            batch[k] = w;
+        }
+        if (a->binary) {
+            len += wireEncodeFrame((unsigned char*)out + len, batch, WIRE_MAX_BATCH);
+        } else {
+            for (int k = 0; k < WIRE_MAX_BATCH; k++) {
+                if (len > WIRE_SEND_BUFFER) {
+                    write_all(fd, out, len);
+                    len = 0;
+                }
+                len += wireFormatText(out + len, WIRE_MAX_FRAME, &batch[k]);
+            }
+        }
+        if (len > WIRE_SEND_BUFFER) {
+            write_all(fd, out, len);
+            len = 0;
+        }
+    }
+    if (len > 0) write_all(fd, out, len);
+    close(fd);
+    return NULL;
+}
+
+static void count_arrival(Vehicle v, void* ctx) {
+    long* totals = (long*)ctx; // received, checksum
+    totals[0]++;
+    totals[1] += v.id;
+}
+
+// Text lines vs binary frames from a generator thread into the simulator's
+// NetServer, over a 127.0.0.1 TCP connection
+static void bench_wire() {
+    for (int binary = 0; binary <= 1; binary++) {
+        NetServer srv;
+        if (openNetServer(&srv, 0, NUM_LANES)) return; // port 0: any free port
+        struct sockaddr_in addr;
+        socklen_t addr_len = sizeof(addr);
+        getsockname(srv.listen_fd, (struct sockaddr*)&addr, &addr_len);
+        WireSenderArg arg = {ntohs(addr.sin_port), binary};
+        long totals[2] = {0, 0};
+        pthread_t thread;
+        double t0 = now_sec();
+        pthread_create(&thread, NULL, wire_sender, &arg);
+        while (totals[0] < WIRE_ARRIVALS) {
+            if (netServerWait(&srv, 1000)) netServerPoll(&srv, count_arrival, totals);
+        }
+        pthread_join(thread, NULL);
+        report(binary ? "wire binary frames (tcp)" : "wire text lines (tcp)", totals[0], now_sec() - t0);
+        closeNetServer(&srv);
+        if (totals[1] == 42) printf("\n");
+    }
+}
+
+#define GRID_BENCH_SIZE 100
+#define GRID_BENCH_MS (300 * 1000)
+#define GRID_MAX_THREADS 8
+
+// 10k-junction grid, sharded over 1-8 worker threads. Results must match
+// the single-threaded run exactly.
+static void bench_grid() {
+    long first_exited = -1;
+    for (int threads = 1; threads <= GRID_MAX_THREADS; threads *= 2) {
+        Grid* g = createGrid(GRID_BENCH_SIZE, GRID_BENCH_SIZE, threads, 10);
+        double t0 = now_sec();
+        runGrid(g, GRID_BENCH_MS);
+        double secs = now_sec() - t0;
+        GridStats gs;
+        getGridStats(g, &gs);
+        if (first_exited < 0) first_exited = gs.exited;
+        if (gs.exited != first_exited) printf("grid results differ with %d threads!\n", threads);
+
+        char name[40];
+        snprintf(name, sizeof(name), "grid %dx%d %d thread(s)", GRID_BENCH_SIZE, GRID_BENCH_SIZE, threads);
+        report(name, gs.intersection_ticks, secs);
+        freeGrid(g);
+    }
+}
+
+#define TRACE_SECONDS 3600
+#define TRACE_MAX (TRACE_SECONDS * NUM_LANES)
+
+// Arrival chance per lane per second (per mille): lane A is the busy one,
+// and every 10 minutes it gets a 30 s surge that trips the priority rule
+static const unsigned int trace_rates[NUM_LANES] = {450, 200, 300, 150};
+
+// Record one hour of seeded arrivals, at most one per lane per second
+static int record_trace(Vehicle* trace) {
+    unsigned int state = 12345;
+    int n = 0;
+    for (int t = 0; t < TRACE_SECONDS; t++) {
+        for (int l = 0; l < NUM_LANES; l++) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            unsigned int rate = trace_rates[l];
+            if (l == 0 && t % 600 < 30) rate = 1000;
+            if (state % 1000 >= rate) continue;
+            Vehicle v = {.id = n, .lane = (unsigned char)l, .arrival_ms = (unsigned int)t * 1000};
+            trace[n++] = v;
+        }
+    }
+    return n;
+}
+
+// Replay the trace through one junction with 1 s dispatch slots
+static void replay_trace(const Vehicle* trace, int count, SchedulerKind kind, int adaptive) {
+    Intersection ix;
+    initIntersection(&ix, GREEN_TIME * 1000);
+    initLaneScheduler(&ix.scheduler, kind);
+    if (adaptive) setAdaptiveTiming(&ix, MIN_GREEN_TIME * 1000, MAX_GREEN_TIME * 1000);
+    WaitHistogram waits;
+    initWaitHistogram(&waits);
+
+    int next = 0;
+    double t0 = now_sec();
+    for (unsigned int now = 0; now <= TRACE_SECONDS * 1000; now += 1000) {
+        while (next < count && trace[next].arrival_ms <= now) {
+            enqueue(ix.lanes[trace[next].lane], trace[next]);
+            next++;
+        }
+        if (now >= ix.light_change_at) changeLight(&ix, now);
+        if (ix.light != GREEN) continue;
+        Vehicle passed[DISPATCH_CAPACITY];
+        DispatchResult d = dispatchIntersection(&ix, now, passed);
+        for (int k = 0; k < d.passed; k++) recordDeparture(&waits, &passed[k]);
+        gapOut(&ix, now);
+    }
+    double secs = now_sec() - t0;
+
+    int left = 0;
+    for (int l = 0; l < NUM_LANES; l++) left += getSize(ix.lanes[l]);
+    printf("%-8s %-13s %6lu served/h  wait mean %6.1fs p99 %6.1fs max %6.1fs  %5d left  (%.2f ms)\n",
+           adaptive ? "adaptive" : "fixed", schedulerName(kind), waits.count, waitMean(&waits) / 1000.0, waitPercentile(&waits, 0.99) / 1000.0,
+           waits.max_ms / 1000.0, left, secs * 1000);
+    freeIntersection(&ix);
+}
+
+// Arrivals per second from the generator engine, per model
+static void bench_arrivals() {
+    for (int m = 0; m < ARRIVAL_TRACE; m++) {
+        ArrivalConfig cfg;
+        defaultArrivalConfig(&cfg, (ArrivalModel)m, 1.0);
+        ArrivalGen gen;
+        initArrivalGen(&gen, &cfg, 42, 1);
+        WireArrival batch[WIRE_MAX_BATCH];
+        long done = 0;
+        double t0 = now_sec();
+        for (unsigned int until = 60 * 1000; done < BENCH_VEHICLES; until += 60 * 1000) {
+            int n;
+            while ((n = takeArrivals(&gen, until, batch, WIRE_MAX_BATCH)) > 0) done += n;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "arrivals %s", arrivalModelName((ArrivalModel)m));
+        report(name, done, now_sec() - t0);
+    }
+}
+
+// Generator lane file output: the old open/lock/print/close per vehicle
+// against LaneWriter writing every vehicle, and buffered
+static const char* bench_lane_files[NUM_LANES] = {
+    "/tmp/bench_lanea.txt", "/tmp/bench_laneb.txt", "/tmp/bench_lanec.txt", "/tmp/bench_laned.txt"
+};
+
+static void bench_lane_writes() {
+    const long reopen_count = 200000;
+    double t0 = now_sec();
+    for (long i = 0; i < reopen_count; i++) {
+        FILE* fp = fopen(bench_lane_files[i % NUM_LANES], "a");
+        if (fp == NULL) return;
+        flock(fileno(fp), LOCK_EX);
+        fprintf(fp, "%ld\n", i);
+        fclose(fp);
+    }
+    report("lane writes fopen/fclose", reopen_count, now_sec() - t0);
+
+    for (int buffered = 0; buffered <= 1; buffered++) {
+        long count = buffered ? BENCH_VEHICLES : reopen_count * 5;
+        LaneWriter w;
+        if (openLaneWriter(&w, bench_lane_files, NUM_LANES, 1, buffered ? LANE_FLUSH_MS : 0)) return;
+        t0 = now_sec();
+        for (long i = 0; i < count; i++) {
+            laneWriterAppend(&w, (int)(i % NUM_LANES), (unsigned int)i);
+            // One flush check per 1000 vehicles, as if they arrived at 10 per ms
+            if (buffered && i % 1000 == 999) laneWriterFlushDue(&w, (unsigned int)(i / 10), (unsigned int)(i / 10));
+        }
+        closeLaneWriter(&w);
+        double secs = now_sec() - t0;
+        report(buffered ? "lane writes buffered" : "lane writes open fd", count, secs);
+        printf("%-28s %10ld write() calls\n", "", w.writes);
+    }
+    for (int l = 0; l < NUM_LANES; l++) remove(bench_lane_files[l]);
+}
+
+// Receiver lane counts: the old fgets rescan of a whole file against
+// countLane() cold (mapped, vector scan) and after small appends
+static void bench_lane_counts() {
+    const long lines = BENCH_VEHICLES;
+    LaneWriter w;
+    if (openLaneWriter(&w, bench_lane_files, 1, 1, LANE_FLUSH_MS)) return;
+    for (long i = 0; i < lines; i++) laneWriterAppend(&w, 0, (unsigned int)i);
+    closeLaneWriter(&w);
+
+    double t0 = now_sec();
+    FILE* fp = fopen(bench_lane_files[0], "r");
+    if (fp == NULL) return;
+    char line[256];
+    long counted = 0;
+    while (fgets(line, sizeof(line), fp)) counted++;
+    fclose(fp);
+    report("lane count fgets rescan", counted, now_sec() - t0);
+
+    LaneIngest in;
+    initLaneIngest(&in, bench_lane_files, 1);
+    t0 = now_sec();
+    counted = countLane(&in, 0);
+    report("lane count cold (mmap)", counted, now_sec() - t0);
+
+    // Steady state: one vehicle appended, then recounted
+    const long appends = 100000;
+    if (openLaneWriter(&w, bench_lane_files, 1, 0, 0)) return;
+    t0 = now_sec();
+    for (long i = 0; i < appends; i++) {
+        laneWriterAppend(&w, 0, (unsigned int)i);
+        counted = countLane(&in, 0);
+    }
+    report("lane count incremental", appends, now_sec() - t0);
+    printf("%-28s %10ld lines counted (expected %ld)\n", "", counted, lines + appends);
+    closeLaneWriter(&w);
+    closeLaneIngest(&in);
+    remove(bench_lane_files[0]);
+}
+
+// Dispatch-path logging: the old fprintf + fflush per line, a log site
+// below the level, and records posted to the async logger
+static void bench_log() {
+    const char* path = "/tmp/bench_sim.log";
+    const long sync_count = 200000;
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) return;
+    double t0 = now_sec();
+    for (long i = 0; i < sync_count; i++) {
+        fprintf(fp, "Vehicle %ld passed from lane %c\n", i, 'A' + (int)(i % 4));
+        fflush(fp);
+    }
+    report("log fprintf+fflush", sync_count, now_sec() - t0);
+    fclose(fp);
+
+    for (int level = LOG_INFO; level <= LOG_DEBUG; level++) {
+        SimLog lg;
+        remove(path);
+        if (openSimLog(&lg, path, "bench", LOG_FORMAT_JSON, (LogLevel)level)) return;
+        // Timed in bursts of one ring; the writer drains between bursts
+        const long count = LOG_RING_SIZE * 128;
+        double secs = 0;
+        for (long i = 0; i < count; i += LOG_RING_SIZE) {
+            t0 = now_sec();
+            for (long k = i; k < i + LOG_RING_SIZE; k++) {
+                SIM_LOG(&lg, LOG_DEBUG, LOG_EV_PASS, (int)(k % 4), 0, (unsigned int)k, (unsigned int)k, 0);
+            }
+            secs += now_sec() - t0;
+            if (level == LOG_DEBUG) usleep(LOG_IDLE_US * 4);
+        }
+        long dropped = lg.dropped;
+        closeSimLog(&lg);
+        report(level == LOG_DEBUG ? "log async posted" : "log site disabled", count, secs);
+        if (level == LOG_DEBUG) printf("%-28s %10ld dropped\n", "", dropped);
+    }
+    remove(path);
+}
+
+// Every lane policy on the same recorded hour of arrivals
+static void bench_schedulers() {
+    static Vehicle trace[TRACE_MAX];
+    int count = record_trace(trace);
+    printf("trace: %d arrivals over %d s\n", count, TRACE_SECONDS);
+    for (int kind = 0; kind < SCHED_KIND_COUNT; kind++) replay_trace(trace, count, (SchedulerKind)kind, 0);
+}
+
+// Fixed 10 s / 5 s cycle against queue-sized green phases, same trace
+static void bench_adaptive() {
+    static Vehicle trace[TRACE_MAX];
+    int count = record_trace(trace);
+    printf("trace: %d arrivals over %d s\n", count, TRACE_SECONDS);
+    for (int kind = 0; kind < SCHED_KIND_COUNT; kind++) {
+        replay_trace(trace, count, (SchedulerKind)kind, 0);
+        replay_trace(trace, count, (SchedulerKind)kind, 1);
+    }
+}
+
+typedef struct {
+    const char* name;
+    void (*run)();
+} Bench;
+
+static const Bench benches[] = {
+    {"queue", bench_queue},
+    {"queue_batch", bench_queue_batch},
+    {"spsc", bench_spsc},
+    {"mpmc", bench_mpmc},
+    {"wire", bench_wire},
+    {"grid", bench_grid},
+    {"schedulers", bench_schedulers},
+    {"adaptive", bench_adaptive},
+    {"arrivals", bench_arrivals},
+    {"lane_writes", bench_lane_writes},
+    {"lane_counts", bench_lane_counts},
+    {"log", bench_log},
+};
+
+int main(int argc, char* argv[]) {
+    int ran = 0;
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (argc > 1 && strcmp(argv[1], benches[i].name) != 0) continue;
+        benches[i].run();
+        ran++;
+    }
+    if (ran == 0) {
+        fprintf(stderr, "Unknown benchmark: %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
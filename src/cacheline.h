@@ -0,0 +1,8 @@
+#ifndef CACHELINE_H
+#define CACHELINE_H
+
+// Alignment for data written by different threads, so they do not share
+// (and keep bouncing) one cache line
+#define CACHE_LINE_SIZE 64
+
+#endif // CACHELINE_H
@@ -0,0 +1,90 @@
+#include "event_queue.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+// Event timeline using a binary min-heap stored in an array
+// Time: O(log n) push/pop, O(1) peek, Space: O(n) for n pending events
+
+#define EVENT_QUEUE_INITIAL_CAPACITY 64
+
+static bool eventBefore(const SimEvent* a, const SimEvent* b) {
+    if (a->time_ms != b->time_ms) return a->time_ms < b->time_ms;
+    if (a->type != b->type) return a->type < b->type;
+    return a->seq < b->seq;
+}
+
+// Create an empty timeline
+EventQueue* createEventQueue() {
+    EventQueue* eq = (EventQueue*)malloc(sizeof(EventQueue));
+    if (eq == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    eq->events = (SimEvent*)malloc(sizeof(SimEvent) * EVENT_QUEUE_INITIAL_CAPACITY);
+    if (eq->events == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    eq->size = 0;
+    eq->capacity = EVENT_QUEUE_INITIAL_CAPACITY;
+    eq->next_seq = 0;
+    return eq;
+}
+
+// Schedule an event (sift up from the end)
+void pushEvent(EventQueue* eq, SimEvent ev) {
+    if (eq->size == eq->capacity) {
+        SimEvent* events = (SimEvent*)realloc(eq->events, sizeof(SimEvent) * eq->capacity * 2);
+        if (events == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        eq->events = events;
+        eq->capacity *= 2;
+    }
+    ev.seq = eq->next_seq++;
+    int i = eq->size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!eventBefore(&ev, &eq->events[parent])) break;
+        eq->events[i] = eq->events[parent];
+        i = parent;
+    }
+    eq->events[i] = ev;
+}
+
+// Remove and return the earliest event (sift the last one down)
+SimEvent popEvent(EventQueue* eq) {
+    if (eq->size == 0) {
+        fprintf(stderr, "Event queue is empty\n");
+        exit(1);
+    }
+    SimEvent top = eq->events[0];
+    SimEvent last = eq->events[--eq->size];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= eq->size) break;
+        if (child + 1 < eq->size && eventBefore(&eq->events[child + 1], &eq->events[child])) child++;
+        if (!eventBefore(&eq->events[child], &last)) break;
+        eq->events[i] = eq->events[child];
+        i = child;
+    }
+    eq->events[i] = last;
+    return top;
+}
+
+// Earliest event without removing it, NULL if none
+SimEvent* peekEvent(EventQueue* eq) {
+    return eq->size > 0 ? &eq->events[0] : NULL;
+}
+
+bool isEventQueueEmpty(EventQueue* eq) {
+    return eq->size == 0;
+}
+
+// Free the timeline
+void freeEventQueue(EventQueue* eq) {
+    free(eq->events);
+    free(eq);
+}
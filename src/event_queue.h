@@ -0,0 +1,40 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdbool.h>
+#include "queue.h"
+
+// Kinds of simulation events. When two events share a timestamp they are
+// handled in this order, which matches the order of work inside one tick
+// of the original polling loop (light update, ingest, dispatch, status).
+typedef enum {
+    EV_LIGHT_CHANGE,
+    EV_ARRIVAL,     // a vehicle joins a lane
+    EV_DEPARTURE,   // a green-phase dispatch slot: vehicles pass the light
+    EV_STATUS       // periodic queue status report
+} EventType;
+
+typedef struct {
+    unsigned int time_ms;   // simulation time the event fires
+    unsigned int seq;       // insertion order, breaks remaining ties
+    EventType type;
+    Vehicle vehicle;        // EV_ARRIVAL payload
+} SimEvent;
+
+// Binary min-heap timeline ordered by (time_ms, type, seq)
+typedef struct {
+    SimEvent* events;
+    int size;
+    int capacity;
+    unsigned int next_seq;
+} EventQueue;
+
+// Function prototypes
+EventQueue* createEventQueue();
+void pushEvent(EventQueue* eq, SimEvent ev);
+SimEvent popEvent(EventQueue* eq);
+SimEvent* peekEvent(EventQueue* eq);
+bool isEventQueueEmpty(EventQueue* eq);
+void freeEventQueue(EventQueue* eq);
+
+#endif // EVENT_QUEUE_H
@@ -1,7 +1,10 @@
 #define SDL_MAIN_HANDLED
+#ifndef GRAPHICS_HEADLESS
 #include <SDL2/SDL.h>
+#endif
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <math.h>
 
@@ -30,6 +33,18 @@
 // SAFE DISTANCE (Braking logic)
 #define STOP_DISTANCE 40
 #define FOLLOW_DISTANCE 50
+#define AHEAD_COS 0.6967f // cos(0.8 rad): "in front" is within 0.8 rad of our heading
+
+#define INITIAL_CAPACITY 256 // vehicle pool; doubles whenever it fills up
+
+// SPATIAL GRID (Collision lookups)
+// Rebuilt every frame from the frame-start positions, which every braking
+// decision reads; a car only checks the 3x3 cells around its own. Cells are
+// wider than FOLLOW_DISTANCE, so every neighbor within range is in them.
+#define CELL_SIZE 64
+#define GRID_MARGIN 100 // cars live up to 100px outside the window
+#define GRID_COLS ((WINDOW_WIDTH + 2 * GRID_MARGIN) / CELL_SIZE + 1)
+#define GRID_ROWS ((WINDOW_HEIGHT + 2 * GRID_MARGIN) / CELL_SIZE + 1)
 
 typedef enum { DIR_N, DIR_S, DIR_E, DIR_W } Direction;
 typedef enum { LIGHT_RED, LIGHT_GREEN, LIGHT_YELLOW } LightState;
@@ -38,25 +53,41 @@ typedef enum { STATE_SPAWN, STATE_DRIVE, STATE_BRAKE, STATE_TURN, STATE_EXIT } C
 
 // --- STRUCTURES ---
 
+// Struct of arrays. The active cars are packed into [0, count): the ones
+// turning first, [0, turning), then everyone else. Each kinematics kernel
+// walks one dense run of plain float arrays, and a car that leaves is
+// replaced by the last one. The heading is kept as a unit vector (hx, hy),
+// so neither driving nor turning needs any trig.
+// The arrays hold capacity cars and double when a spawn finds them full.
+// Packing makes [count, capacity) the free list: spawning takes slot count
+// and despawning hands back the last slot, both O(1).
 typedef struct {
-    float x, y;
-    float angle;      // Radians
-    Direction dir;    // Origin direction
-    int lane;         // 0=Left, 1=Center, 2=Right
-    TurnIntent intent;
-    CarState state;
-    
+    float* x;
+    float* y;
+    float* hx;          // heading (cos, sin)
+    float* hy;
+    float* speed;       // this frame's straight step: SPEED, 0 when braking
+
     // Turning Math
-    float pivot_x, pivot_y;
-    float radius;
-    float target_angle;
-    float current_arc_angle;
-    
-    int active;
-} Vehicle;
+    float* pivot_x;
+    float* pivot_y;
+    float* radius;
+    float* ux;          // unit vector from the pivot to the car
+    float* uy;
+    float* turn_sign;   // +1 left (counter-clockwise), -1 right
+
+    unsigned char* dir;     // Origin direction
+    unsigned char* lane;    // 0=Left, 1=Center, 2=Right
+    unsigned char* intent;
+    unsigned char* state;
+
+    int count;
+    int turning;
+    int capacity;
+} Cars;
 
 // --- GLOBALS ---
-Vehicle vehicles[200];
+Cars cars;
 int frame = 0;
 LightState light_NS = LIGHT_GREEN;
 LightState light_EW = LIGHT_RED;
@@ -69,39 +100,118 @@ float get_lane_center(int lane_idx) {
     return (lane_idx * LANE_WIDTH) + (LANE_WIDTH / 2.0f);
 }
 
-// Convert direction enum to angle
-float dir_to_angle(Direction d) {
-    switch(d) {
-        case DIR_N: return -M_PI / 2.0f; // Up
-        case DIR_S: return M_PI / 2.0f;  // Down
-        case DIR_E: return 0.0f;         // Right
-        case DIR_W: return M_PI;         // Left
+// Unit heading of a direction
+void dir_to_heading(Direction d, float* hx, float* hy) {
+    *hx = d == DIR_E ? 1.0f : d == DIR_W ? -1.0f : 0.0f;
+    *hy = d == DIR_S ? 1.0f : d == DIR_N ? -1.0f : 0.0f; // Screen y points down
+}
+
+#define SWAP_FIELD(f, a, b) do { __typeof__(cars.f[0]) t_ = cars.f[a]; cars.f[a] = cars.f[b]; cars.f[b] = t_; } while(0)
+
+void swap_cars(int a, int b) {
+    if(a == b) return;
+    SWAP_FIELD(x, a, b); SWAP_FIELD(y, a, b);
+    SWAP_FIELD(hx, a, b); SWAP_FIELD(hy, a, b);
+    SWAP_FIELD(speed, a, b);
+    SWAP_FIELD(pivot_x, a, b); SWAP_FIELD(pivot_y, a, b); SWAP_FIELD(radius, a, b);
+    SWAP_FIELD(ux, a, b); SWAP_FIELD(uy, a, b); SWAP_FIELD(turn_sign, a, b);
+    SWAP_FIELD(dir, a, b); SWAP_FIELD(lane, a, b); SWAP_FIELD(intent, a, b); SWAP_FIELD(state, a, b);
+}
+
+// Move cars whose state changed across the turning / not turning boundary
+void partition_turning() {
+    // Turning run: the car swapped in from the end of the run is already checked
+    for(int i = cars.turning - 1; i >= 0; i--) {
+        if(cars.state[i] != STATE_TURN) swap_cars(i, --cars.turning);
+    }
+    // Everyone else: the car swapped in from the start of the run is not turning
+    for(int i = cars.turning; i < cars.count; i++) {
+        if(cars.state[i] == STATE_TURN) swap_cars(i, cars.turning++);
+    }
+}
+
+// --- SPATIAL GRID ---
+// Active cars sorted by cell, with their positions copied alongside, so a
+// lookup scans three contiguous runs (one per row of the 3x3 block).
+// Positions are those at the start of the frame, so every car sees the
+// same picture whatever order the cars are updated in.
+int cell_start[GRID_COLS * GRID_ROWS + 1]; // cell c holds slots cell_start[c] .. cell_start[c+1]-1
+int cell_fill[GRID_COLS * GRID_ROWS];
+float* grid_x;       // these four grow with the vehicle pool
+float* grid_y;
+int* vehicle_cell;
+int* vehicle_slot;
+
+int cell_of(float x, float y) {
+    int col = (int)((x + GRID_MARGIN) / CELL_SIZE);
+    int row = (int)((y + GRID_MARGIN) / CELL_SIZE);
+    if(col < 0) col = 0;
+    if(col >= GRID_COLS) col = GRID_COLS - 1;
+    if(row < 0) row = 0;
+    if(row >= GRID_ROWS) row = GRID_ROWS - 1;
+    return row * GRID_COLS + col;
+}
+
+// Bucket every active car by cell (counting sort, O(n))
+void build_grid() {
+    memset(cell_start, 0, sizeof(cell_start));
+    for(int i=0; i<cars.count; i++) {
+        vehicle_cell[i] = cell_of(cars.x[i], cars.y[i]);
+        cell_start[vehicle_cell[i] + 1]++;
+    }
+    for(int c=0; c<GRID_COLS * GRID_ROWS; c++) cell_start[c + 1] += cell_start[c];
+    memcpy(cell_fill, cell_start, sizeof(cell_fill));
+    for(int i=0; i<cars.count; i++) {
+        int slot = cell_fill[vehicle_cell[i]]++;
+        grid_x[slot] = cars.x[i];
+        grid_y[slot] = cars.y[i];
+        vehicle_slot[i] = slot;
+    }
+}
+
+// Any car within FOLLOW_DISTANCE in front of (x, y, heading) among slots [from, to)?
+int blocked_in(int from, int to, int self_slot, float x, float y, float hx, float hy) {
+    for(int k = from; k < to; k++) {
+        // Squared distance check
+        float dx = grid_x[k] - x;
+        float dy = grid_y[k] - y;
+        float dist2 = dx*dx + dy*dy;
+        if(dist2 >= FOLLOW_DISTANCE * FOLLOW_DISTANCE || k == self_slot) continue;
+
+        // IN FRONT: the direction to the other car is within 0.8 rad of
+        // our heading, i.e. dot > |d| * cos(0.8)
+        float dot = dx*hx + dy*hy;
+        if(dot > 0 && dot*dot > dist2 * AHEAD_COS * AHEAD_COS) return 1;
     }
     return 0;
 }
 
-// Check collision with other cars
+// Check collision with other cars in the surrounding cells
 int is_blocked(int self_idx) {
-    Vehicle* v = &vehicles[self_idx];
-    
-    for(int i=0; i<200; i++) {
-        if(i == self_idx || !vehicles[i].active) continue;
-        Vehicle* other = &vehicles[i];
-        
-        // Simple distance check
-        float dx = v->x - other->x;
-        float dy = v->y - other->y;
-        float dist = sqrt(dx*dx + dy*dy);
-        
-        // Check if other car is IN FRONT relative to our angle
-        // (Dot product or simple logic based on direction)
-        if(dist < FOLLOW_DISTANCE) {
-            float angle_to_other = atan2(other->y - v->y, other->x - v->x);
-            float angle_diff = fabs(angle_to_other - v->angle);
-            while(angle_diff > M_PI) angle_diff -= 2*M_PI;
-            
-            // If strictly in front (within 45 degrees)
-            if(fabs(angle_diff) < 0.8f) return 1;
+    int self_slot = vehicle_slot[self_idx];
+    float x = grid_x[self_slot];
+    float y = grid_y[self_slot];
+    float hx = cars.hx[self_idx];
+    float hy = cars.hy[self_idx];
+    int cell = vehicle_cell[self_idx];
+    int col = cell % GRID_COLS;
+    int row = cell / GRID_COLS;
+    int c0 = col > 0 ? col - 1 : col;
+    int c1 = col < GRID_COLS - 1 ? col + 1 : col;
+
+    // Own cell first: in a crowded scene the car ahead is usually there,
+    // and the neighbors (oncoming lanes, cross traffic) are never scanned
+    if(blocked_in(cell_start[cell], cell_start[cell + 1], self_slot, x, y, hx, hy)) return 1;
+    for(int r = row - 1; r <= row + 1; r++) {
+        if(r < 0 || r >= GRID_ROWS) continue;
+        int first = cell_start[r * GRID_COLS + c0];
+        int last = cell_start[r * GRID_COLS + c1 + 1];
+        if(r == row) {
+            // Own cell already done: only the cells either side of it
+            if(blocked_in(first, cell_start[cell], self_slot, x, y, hx, hy)) return 1;
+            if(blocked_in(cell_start[cell + 1], last, self_slot, x, y, hx, hy)) return 1;
+        } else if(blocked_in(first, last, self_slot, x, y, hx, hy)) {
+            return 1;
         }
     }
     return 0;
@@ -109,49 +219,71 @@ int is_blocked(int self_idx) {
 
 // --- LOGIC ---
 
+void* grow_array(void* p, size_t elem, int capacity) {
+    p = realloc(p, elem * capacity);
+    if(p == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return p;
+}
+
+#define GROW(arr, cap) ((arr) = grow_array((arr), sizeof(*(arr)), (cap)))
+
+// Make room for at least n cars (doubling, so spawning stays amortized O(1))
+void reserve_cars(int n) {
+    if(n <= cars.capacity) return;
+    int cap = cars.capacity ? cars.capacity : INITIAL_CAPACITY;
+    while(cap < n) cap *= 2;
+    GROW(cars.x, cap); GROW(cars.y, cap);
+    GROW(cars.hx, cap); GROW(cars.hy, cap);
+    GROW(cars.speed, cap);
+    GROW(cars.pivot_x, cap); GROW(cars.pivot_y, cap); GROW(cars.radius, cap);
+    GROW(cars.ux, cap); GROW(cars.uy, cap); GROW(cars.turn_sign, cap);
+    GROW(cars.dir, cap); GROW(cars.lane, cap); GROW(cars.intent, cap); GROW(cars.state, cap);
+    GROW(grid_x, cap); GROW(grid_y, cap);
+    GROW(vehicle_cell, cap); GROW(vehicle_slot, cap);
+    cars.capacity = cap;
+}
+
 void spawn_vehicle() {
-    int idx = -1;
-    for(int i=0; i<200; i++) { if(!vehicles[i].active) { idx = i; break; } }
-    if(idx == -1) return;
-
-    Vehicle* v = &vehicles[idx];
-    v->active = 1;
-    v->dir = rand() % 4;
-    v->lane = rand() % 3; // 0, 1, 2
-    v->state = STATE_DRIVE;
-    
+    reserve_cars(cars.count + 1);
+    int i = cars.count++;
+
+    cars.dir[i] = rand() % 4;
+    cars.lane[i] = rand() % 3; // 0, 1, 2
+    cars.state[i] = STATE_DRIVE;
+    cars.speed[i] = 0;
+
     // STRICT LANE RULES
-    if(v->lane == 0) v->intent = TURN_LEFT;
-    else if(v->lane == 1) v->intent = TURN_STRAIGHT;
-    else v->intent = TURN_RIGHT;
+    if(cars.lane[i] == 0) cars.intent[i] = TURN_LEFT;
+    else if(cars.lane[i] == 1) cars.intent[i] = TURN_STRAIGHT;
+    else cars.intent[i] = TURN_RIGHT;
 
     float cx = WINDOW_WIDTH / 2.0f;
     float cy = WINDOW_HEIGHT / 2.0f;
-    float offset = get_lane_center(v->lane); // Offset from center line
+    float offset = get_lane_center(cars.lane[i]); // Offset from center line
 
     // Setup Start Position strictly in lane
-    switch(v->dir) {
+    switch(cars.dir[i]) {
         case DIR_N: // Going North (Start Bottom)
-            v->x = cx + offset; 
-            v->y = WINDOW_HEIGHT + 50;
-            v->angle = -M_PI/2;
+            cars.x[i] = cx + offset;
+            cars.y[i] = WINDOW_HEIGHT + 50;
             break;
         case DIR_S: // Going South (Start Top)
-            v->x = cx - offset; 
-            v->y = -50;
-            v->angle = M_PI/2;
+            cars.x[i] = cx - offset;
+            cars.y[i] = -50;
             break;
         case DIR_E: // Going East (Start Left)
-            v->x = -50; 
-            v->y = cy + offset;
-            v->angle = 0;
+            cars.x[i] = -50;
+            cars.y[i] = cy + offset;
             break;
         case DIR_W: // Going West (Start Right)
-            v->x = WINDOW_WIDTH + 50; 
-            v->y = cy - offset;
-            v->angle = M_PI;
+            cars.x[i] = WINDOW_WIDTH + 50;
+            cars.y[i] = cy - offset;
             break;
     }
+    dir_to_heading(cars.dir[i], &cars.hx[i], &cars.hy[i]);
 }
 
 void update_traffic_lights() {
@@ -164,147 +296,225 @@ void update_traffic_lights() {
     else { light_NS = LIGHT_RED; light_EW = LIGHT_YELLOW; }
 }
 
+// Set up the arc for a car entering the intersection (Mathematical Pivot
+// Calculation). (ux, uy) is where the car sits relative to the pivot.
+void start_turn(int i, float cx, float cy) {
+    cars.state[i] = STATE_TURN;
+    float lane_offset = get_lane_center(cars.lane[i]);
+
+    if(cars.intent[i] == TURN_RIGHT) {
+        // Pivot is the close corner; the rightmost lane has the tightest arc
+        cars.radius[i] = ROAD_HALF_WIDTH - lane_offset;
+        cars.turn_sign[i] = -1.0f; // Clockwise
+        switch(cars.dir[i]) {
+            case DIR_N: cars.pivot_x[i] = cx + ROAD_HALF_WIDTH; cars.pivot_y[i] = cy + ROAD_HALF_WIDTH; cars.ux[i] = -1; cars.uy[i] = 0; break;
+            case DIR_S: cars.pivot_x[i] = cx - ROAD_HALF_WIDTH; cars.pivot_y[i] = cy - ROAD_HALF_WIDTH; cars.ux[i] = 1; cars.uy[i] = 0; break;
+            case DIR_E: cars.pivot_x[i] = cx - ROAD_HALF_WIDTH; cars.pivot_y[i] = cy + ROAD_HALF_WIDTH; cars.ux[i] = 0; cars.uy[i] = -1; break;
+            case DIR_W: cars.pivot_x[i] = cx + ROAD_HALF_WIDTH; cars.pivot_y[i] = cy - ROAD_HALF_WIDTH; cars.ux[i] = 0; cars.uy[i] = 1; break;
+        }
+    } else {
+        // Pivot is the FAR corner
+        cars.radius[i] = ROAD_HALF_WIDTH + lane_offset;
+        cars.turn_sign[i] = 1.0f; // Counter-Clockwise
+        switch(cars.dir[i]) {
+            case DIR_N: cars.pivot_x[i] = cx - ROAD_HALF_WIDTH; cars.pivot_y[i] = cy + ROAD_HALF_WIDTH; cars.ux[i] = 1; cars.uy[i] = 0; break;
+            case DIR_S: cars.pivot_x[i] = cx + ROAD_HALF_WIDTH; cars.pivot_y[i] = cy - ROAD_HALF_WIDTH; cars.ux[i] = -1; cars.uy[i] = 0; break;
+            case DIR_E: cars.pivot_x[i] = cx - ROAD_HALF_WIDTH; cars.pivot_y[i] = cy - ROAD_HALF_WIDTH; cars.ux[i] = 0; cars.uy[i] = 1; break;
+            case DIR_W: cars.pivot_x[i] = cx + ROAD_HALF_WIDTH; cars.pivot_y[i] = cy + ROAD_HALF_WIDTH; cars.ux[i] = 0; cars.uy[i] = -1; break;
+        }
+    }
+}
+
+// Braking, collision and turn decisions for one car (no movement yet)
+void decide_vehicle(int i, float cx, float cy, float stop_boundary) {
+    // 1. BRAKING LOGIC (Traffic Lights)
+    int approaching_light = 0;
+    float dist_to_center = 0;
+
+    // Calculate distance to intersection center
+    switch(cars.dir[i]) {
+        case DIR_N: dist_to_center = cars.y[i] - cy; break;
+        case DIR_S: dist_to_center = cy - cars.y[i]; break;
+        case DIR_E: dist_to_center = cx - cars.x[i]; break;
+        case DIR_W: dist_to_center = cars.x[i] - cx; break;
+    }
+
+    // Check Light Color
+    LightState my_light = (cars.dir[i] == DIR_N || cars.dir[i] == DIR_S) ? light_NS : light_EW;
+
+    // If near stop line and light is not Green
+    int state = cars.state[i];
+    if(state != STATE_TURN && state != STATE_EXIT) {
+        if(dist_to_center > 0 && dist_to_center < stop_boundary + STOP_DISTANCE && my_light != LIGHT_GREEN) {
+            approaching_light = 1;
+        }
+    }
+
+    // 2. COLLISION CHECK / 3. STATE UPDATES
+    if(is_blocked(i) || approaching_light) {
+        cars.state[i] = STATE_BRAKE;
+    } else if(cars.state[i] == STATE_BRAKE) {
+        cars.state[i] = STATE_DRIVE;
+    }
+
+    // 4. INITIATE TURN when we hit the stop line/entrance of intersection
+    if(cars.state[i] == STATE_DRIVE && dist_to_center <= stop_boundary + 5 && dist_to_center >= stop_boundary - 5) {
+        if(cars.intent[i] != TURN_STRAIGHT) start_turn(i, cx, cy);
+        else cars.state[i] = STATE_EXIT; // Drive straight through
+    }
+    cars.speed[i] = (cars.state[i] == STATE_DRIVE || cars.state[i] == STATE_EXIT) ? SPEED : 0.0f;
+}
+
+// 5. PHYSICS: straight driving over n cars. Braking cars have speed 0, so
+// there is no branch and the loop vectorizes.
+void drive_run(int n, float* restrict x, float* restrict y, const float* restrict hx, const float* restrict hy,
+               const float* restrict speed) {
+    for(int i = 0; i < n; i++) {
+        x[i] += hx[i] * speed[i];
+        y[i] += hy[i] * speed[i];
+    }
+}
+
+void drive_kernel(int from, int to) {
+    if(to > from) drive_run(to - from, cars.x + from, cars.y + from, cars.hx + from, cars.hy + from, cars.speed + from);
+}
+
+// 5. PHYSICS: move n cars along their arc by rotating the pivot offset
+// (ux, uy) and the heading by TURN_SPEED (a fixed rotation, so no per-car trig)
+void turn_run(int n, float* restrict x, float* restrict y, float* restrict ux, float* restrict uy,
+              float* restrict hx, float* restrict hy, const float* restrict pivot_x, const float* restrict pivot_y,
+              const float* restrict radius, const float* restrict turn_sign) {
+    const float c = cosf(TURN_SPEED);
+    const float s = sinf(TURN_SPEED);
+    for(int i = 0; i < n; i++) {
+        float sn = s * turn_sign[i];
+        float nux = ux[i] * c - uy[i] * sn;
+        float nuy = uy[i] * c + ux[i] * sn;
+        float nhx = hx[i] * c - hy[i] * sn;
+        float nhy = hy[i] * c + hx[i] * sn;
+        ux[i] = nux;
+        uy[i] = nuy;
+        hx[i] = nhx;
+        hy[i] = nhy;
+        x[i] = pivot_x[i] + radius[i] * nux;
+        y[i] = pivot_y[i] + radius[i] * nuy;
+    }
+}
+
+void turn_kernel(int n) {
+    turn_run(n, cars.x, cars.y, cars.ux, cars.uy, cars.hx, cars.hy, cars.pivot_x, cars.pivot_y, cars.radius,
+             cars.turn_sign);
+}
+
+// Turn done once the heading is back on an axis, away from the center
+void finish_turns(float cx, float cy) {
+    for(int i = 0; i < cars.turning; i++) {
+        float abs_sin = fabsf(cars.hy[i]);
+        float abs_cos = fabsf(cars.hx[i]);
+        if((abs_sin < 0.05f || abs_cos < 0.05f) && (fabsf(cars.x[i] - cx) > 10 || fabsf(cars.y[i] - cy) > 10)) {
+            cars.state[i] = STATE_EXIT;
+            // Snap to axis
+            if(abs_sin < 0.05f) { cars.hx[i] = cars.hx[i] > 0 ? 1.0f : -1.0f; cars.hy[i] = 0; }
+            else { cars.hy[i] = cars.hy[i] > 0 ? 1.0f : -1.0f; cars.hx[i] = 0; }
+        }
+    }
+}
+
 void update_vehicles() {
     float cx = WINDOW_WIDTH / 2.0f;
     float cy = WINDOW_HEIGHT / 2.0f;
     float stop_boundary = INTERSECTION_SIZE / 2.0f;
 
-    for(int i=0; i<200; i++) {
-        Vehicle* v = &vehicles[i];
-        if(!v->active) continue;
-
-        // 1. BRAKING LOGIC (Traffic Lights)
-        int approaching_light = 0;
-        float dist_to_center = 0;
-
-        // Calculate distance to intersection center
-        if(v->dir == DIR_N) dist_to_center = v->y - cy;
-        if(v->dir == DIR_S) dist_to_center = cy - v->y;
-        if(v->dir == DIR_E) dist_to_center = cx - v->x;
-        if(v->dir == DIR_W) dist_to_center = v->x - cx;
-
-        // Check Light Color
-        LightState my_light = (v->dir == DIR_N || v->dir == DIR_S) ? light_NS : light_EW;
-
-        // If near stop line and light is not Green
-        if(v->state != STATE_TURN && v->state != STATE_EXIT) {
-            if(dist_to_center > 0 && dist_to_center < stop_boundary + STOP_DISTANCE) {
-                if(my_light != LIGHT_GREEN) {
-                    approaching_light = 1;
-                }
-            }
-        }
-
-        // 2. COLLISION CHECK
-        int blocked = is_blocked(i);
+    build_grid();
+    for(int i=0; i<cars.count; i++) decide_vehicle(i, cx, cy, stop_boundary);
+    partition_turning();
 
-        // 3. STATE UPDATES
-        if(blocked || approaching_light) {
-            v->state = STATE_BRAKE;
-        } else if (v->state == STATE_BRAKE) {
-            v->state = STATE_DRIVE;
-        }
+    turn_kernel(cars.turning);
+    drive_kernel(cars.turning, cars.count);
+    finish_turns(cx, cy);
+    partition_turning();
 
-        // 4. INITIATE TURN (Mathematical Pivot Calculation)
-        // Trigger turn when we hit the stop line/entrance of intersection
-        if(v->state == STATE_DRIVE && dist_to_center <= stop_boundary + 5 && dist_to_center >= stop_boundary - 5) {
-            if(v->intent != TURN_STRAIGHT) {
-                v->state = STATE_TURN;
-                
-                float lane_offset = get_lane_center(v->lane);
-                
-                if(v->intent == TURN_RIGHT) {
-                    // Pivot is the close corner. 
-                    // Radius = Lane Offset from center line + Lane Width/2 (No, simpler: Distance from center to lane center)
-                    // Radius = (Road_Half_Width) - Lane_Offset
-                    // Actually, simpler math:
-                    // If turning Right, Pivot is (Corner X, Corner Y)
-                    
-                    v->radius = ROAD_HALF_WIDTH - lane_offset; // Inner lanes have larger radius relative to corner? No.
-                    // Lane 2 (Rightmost) has smallest radius.
-                    // Lane 0 (Leftmost) has largest radius... wait, Lane 0 turns LEFT.
-                    // Lane 2 turns RIGHT. Lane 2 is outer.
-                    // Radius = 75 - (2*25 + 12.5) = 12.5 (very tight).
-                    
-                    // Let's calculate PIVOT coordinates
-                    if(v->dir == DIR_N) { v->pivot_x = cx + ROAD_HALF_WIDTH; v->pivot_y = cy + ROAD_HALF_WIDTH; v->current_arc_angle = M_PI; }
-                    if(v->dir == DIR_S) { v->pivot_x = cx - ROAD_HALF_WIDTH; v->pivot_y = cy - ROAD_HALF_WIDTH; v->current_arc_angle = 0; }
-                    if(v->dir == DIR_E) { v->pivot_x = cx - ROAD_HALF_WIDTH; v->pivot_y = cy + ROAD_HALF_WIDTH; v->current_arc_angle = -M_PI/2; }
-                    if(v->dir == DIR_W) { v->pivot_x = cx + ROAD_HALF_WIDTH; v->pivot_y = cy - ROAD_HALF_WIDTH; v->current_arc_angle = M_PI/2; }
-                } 
-                else if(v->intent == TURN_LEFT) {
-                    // Pivot is the FAR corner
-                    v->radius = ROAD_HALF_WIDTH + lane_offset;
-                    
-                    if(v->dir == DIR_N) { v->pivot_x = cx - ROAD_HALF_WIDTH; v->pivot_y = cy + ROAD_HALF_WIDTH; v->current_arc_angle = 0; }
-                    if(v->dir == DIR_S) { v->pivot_x = cx + ROAD_HALF_WIDTH; v->pivot_y = cy - ROAD_HALF_WIDTH; v->current_arc_angle = M_PI; }
-                    if(v->dir == DIR_E) { v->pivot_x = cx - ROAD_HALF_WIDTH; v->pivot_y = cy - ROAD_HALF_WIDTH; v->current_arc_angle = M_PI/2; }
-                    if(v->dir == DIR_W) { v->pivot_x = cx + ROAD_HALF_WIDTH; v->pivot_y = cy + ROAD_HALF_WIDTH; v->current_arc_angle = 3*M_PI/2; }
-                }
-            } else {
-                v->state = STATE_EXIT; // Drive straight through
-            }
+    // 6. DESPAWN (turning cars are inside the intersection)
+    for(int i = cars.count - 1; i >= cars.turning; i--) {
+        if(cars.x[i] < -100 || cars.x[i] > WINDOW_WIDTH+100 || cars.y[i] < -100 || cars.y[i] > WINDOW_HEIGHT+100) {
+            swap_cars(i, --cars.count);
         }
+    }
+}
 
-        // 5. PHYSICS APPLICATION
-        if(v->state == STATE_BRAKE) {
-            // Do nothing, stopped
-        } 
-        else if(v->state == STATE_TURN) {
-            // Move along ARC
-            if(v->intent == TURN_RIGHT) {
-                v->current_arc_angle -= TURN_SPEED; // Clockwise
-                v->angle -= TURN_SPEED;
-            } else {
-                v->current_arc_angle += TURN_SPEED; // Counter-Clockwise
-                v->angle += TURN_SPEED;
-            }
-            
-            v->x = v->pivot_x + v->radius * cos(v->current_arc_angle);
-            v->y = v->pivot_y + v->radius * sin(v->current_arc_angle);
-
-            // Check if turn done (90 degrees moved)
-            // Simplified check: if angle matches target
-            // OR simply check if we have aligned with grid
-            float abs_sin = fabs(sin(v->angle));
-            float abs_cos = fabs(cos(v->angle));
-            if( (abs_sin < 0.05 || abs_cos < 0.05) && (fabs(v->x - cx) > 10 || fabs(v->y - cy) > 10) ) {
-                v->state = STATE_EXIT;
-                // Snap to axis
-                if(abs_sin < 0.05) v->angle = (cos(v->angle) > 0) ? 0 : M_PI;
-                else v->angle = (sin(v->angle) > 0) ? M_PI/2 : -M_PI/2;
-            }
-        } 
-        else {
-            // Drive Straight (Vector)
-            v->x += cos(v->angle) * SPEED;
-            v->y += sin(v->angle) * SPEED;
-        }
+// Stress scene: add count cars spread along their lanes, off screen ends included
+void scatter_vehicles(int count) {
+    reserve_cars(cars.count + count);
+    for(int n=0; n<count; n++) {
+        spawn_vehicle();
+        int i = cars.count - 1;
+        if(cars.dir[i] == DIR_N || cars.dir[i] == DIR_S) cars.y[i] = rand() % (WINDOW_HEIGHT + 200) - 100;
+        else cars.x[i] = rand() % (WINDOW_WIDTH + 200) - 100;
+    }
+}
 
-        // 6. DESPAWN
-        if(v->x < -100 || v->x > WINDOW_WIDTH+100 || v->y < -100 || v->y > WINDOW_HEIGHT+100) {
-            v->active = 0;
+// --- RENDER ---
+#ifndef GRAPHICS_HEADLESS
+
+// Every car is one quad in a single SDL_RenderGeometry batch, and circles are
+// copies of a cached texture, so a frame costs the same few draw calls
+// whatever the number of cars.
+SDL_Texture* light_tex; // lamp, radius 6
+SDL_Texture* dot_tex;   // intersection center dot, radius 7
+SDL_Vertex* car_verts;  // 4 per car
+int* car_index;         // 6 per car (two triangles)
+int car_batch_cap = 0;
+
+// The road never changes, so it is drawn once into road_layer and copied
+// in each frame. road_dirty asks for a redraw (resize, lost render targets,
+// a config change).
+#define FRAME_STATS_INTERVAL 120 // frames per render-time report in the title
+SDL_Texture* road_layer = NULL;
+int road_dirty = 1;
+
+// White filled circle on a transparent square, tinted with SDL_SetTextureColorMod
+SDL_Texture* make_circle_texture(SDL_Renderer* ren, int radius) {
+    int size = radius * 2 + 1;
+    Uint32* pixels = (Uint32*)malloc(sizeof(Uint32) * size * size);
+    if(pixels == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for(int dy = -radius; dy <= radius; dy++) {
+        for(int dx = -radius; dx <= radius; dx++) {
+            pixels[(dy + radius) * size + dx + radius] = dx*dx + dy*dy <= radius*radius ? 0xFFFFFFFF : 0xFFFFFF00;
         }
     }
+    SDL_Texture* tex = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STATIC, size, size);
+    if(tex) {
+        SDL_UpdateTexture(tex, NULL, pixels, size * sizeof(Uint32));
+        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    }
+    free(pixels);
+    return tex;
 }
 
-// --- RENDER ---
+// (Re)create the circle textures. After a device reset every texture is
+// invalid, so the old ones are thrown away and the road layer is rebuilt.
+void create_textures(SDL_Renderer* ren) {
+    if(light_tex) SDL_DestroyTexture(light_tex);
+    if(dot_tex) SDL_DestroyTexture(dot_tex);
+    if(road_layer) SDL_DestroyTexture(road_layer);
+    road_layer = NULL;
+    road_dirty = 1;
+    light_tex = make_circle_texture(ren, 6);
+    dot_tex = make_circle_texture(ren, 7);
+}
+
+void draw_circle(SDL_Renderer* ren, SDL_Texture* tex, int radius, int x, int y, Uint8 r, Uint8 g, Uint8 b) {
+    SDL_Rect dst = { x - radius, y - radius, radius * 2 + 1, radius * 2 + 1 };
+    SDL_SetTextureColorMod(tex, r, g, b);
+    SDL_RenderCopy(ren, tex, NULL, &dst);
+}
 
 void draw_minimal_road(SDL_Renderer* ren) {
     // 4. Draw intersection center dot (very subtle)
-    SDL_SetRenderDrawColor(ren, 180, 180, 200, 180);
-    int dot_r = 7;
-    int dot_cx = WINDOW_WIDTH / 2;
-    int dot_cy = WINDOW_HEIGHT / 2;
-    for(int w=0; w<dot_r*2; w++) {
-        for(int h=0; h<dot_r*2; h++) {
-            int dx = w - dot_r;
-            int dy = h - dot_r;
-            if(dx*dx + dy*dy <= dot_r*dot_r) {
-                SDL_RenderDrawPoint(ren, dot_cx + dx, dot_cy + dy);
-            }
-        }
-    }
+    draw_circle(ren, dot_tex, 7, WINDOW_WIDTH / 2, WINDOW_HEIGHT / 2, 180, 180, 200);
     // 1. Draw Road Shoulder (Even Lighter Gray)
     SDL_SetRenderDrawColor(ren, 50, 50, 50, 255); // Shoulder color
     SDL_Rect v_shoulder = { (WINDOW_WIDTH - ROAD_FULL_WIDTH)/2 - 6, 0, ROAD_FULL_WIDTH + 12, WINDOW_HEIGHT };
@@ -386,6 +596,27 @@ void draw_minimal_road(SDL_Renderer* ren) {
     }
 }
 
+void draw_background(SDL_Renderer* ren) {
+    SDL_SetRenderDrawColor(ren, 180, 180, 180, 255); // Gray background
+    SDL_RenderClear(ren);
+    draw_minimal_road(ren);
+}
+
+// Redraw the cached road layer. Returns 0 if the renderer has no render
+// targets, in which case the road is drawn directly every frame.
+int build_road_layer(SDL_Renderer* ren) {
+    if(road_layer == NULL) {
+        road_layer = SDL_CreateTexture(ren, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH, WINDOW_HEIGHT);
+        if(road_layer == NULL) return 0;
+        SDL_SetTextureBlendMode(road_layer, SDL_BLENDMODE_NONE);
+    }
+    if(SDL_SetRenderTarget(ren, road_layer) < 0) return 0;
+    draw_background(ren);
+    SDL_SetRenderTarget(ren, NULL);
+    road_dirty = 0;
+    return 1;
+}
+
 void draw_traffic_lights(SDL_Renderer* ren) {
     // Positions for lights
     int cx = WINDOW_WIDTH / 2;
@@ -393,54 +624,26 @@ void draw_traffic_lights(SDL_Renderer* ren) {
 
     // Helper to draw a traffic light
     void draw_traffic_light(int x, int y, LightState s) {
-        // Black pole, taller and thicker
-        SDL_Rect pole = {x-3, y-25, 6, 50};
-        SDL_SetRenderDrawColor(ren, 50, 50, 50, 255); // Lighter dark gray
-        SDL_RenderFillRect(ren, &pole);
-        
         // Positions for the three lights
         int red_y = y - 15;
         int yellow_y = y;
         int green_y = y + 15;
         
-        // Draw housings (dark gray squares)
-        SDL_Rect housing_red = {x-8, red_y-8, 16, 16};
-        SDL_RenderFillRect(ren, &housing_red);
-        SDL_Rect housing_yellow = {x-8, yellow_y-8, 16, 16};
-        SDL_RenderFillRect(ren, &housing_yellow);
-        SDL_Rect housing_green = {x-8, green_y-8, 16, 16};
-        SDL_RenderFillRect(ren, &housing_green);
+        // Black pole, taller and thicker, and the housings (dark gray
+        // squares) in one call
+        SDL_SetRenderDrawColor(ren, 50, 50, 50, 255); // Lighter dark gray
+        SDL_Rect parts[4] = {
+            {x-3, y-25, 6, 50},
+            {x-8, red_y-8, 16, 16},
+            {x-8, yellow_y-8, 16, 16},
+            {x-8, green_y-8, 16, 16}
+        };
+        SDL_RenderFillRects(ren, parts, 4);
         
         // Draw the active light
-        int radius = 6;
-        if(s == LIGHT_RED) {
-            SDL_SetRenderDrawColor(ren, 255, 50, 50, 255);
-            for(int dx = -radius; dx <= radius; dx++) {
-                for(int dy = -radius; dy <= radius; dy++) {
-                    if(dx*dx + dy*dy <= radius*radius) {
-                        SDL_RenderDrawPoint(ren, x + dx, red_y + dy);
-                    }
-                }
-            }
-        } else if(s == LIGHT_YELLOW) {
-            SDL_SetRenderDrawColor(ren, 255, 200, 0, 255);
-            for(int dx = -radius; dx <= radius; dx++) {
-                for(int dy = -radius; dy <= radius; dy++) {
-                    if(dx*dx + dy*dy <= radius*radius) {
-                        SDL_RenderDrawPoint(ren, x + dx, yellow_y + dy);
-                    }
-                }
-            }
-        } else if(s == LIGHT_GREEN) {
-            SDL_SetRenderDrawColor(ren, 0, 255, 100, 255);
-            for(int dx = -radius; dx <= radius; dx++) {
-                for(int dy = -radius; dy <= radius; dy++) {
-                    if(dx*dx + dy*dy <= radius*radius) {
-                        SDL_RenderDrawPoint(ren, x + dx, green_y + dy);
-                    }
-                }
-            }
-        }
+        if(s == LIGHT_RED) draw_circle(ren, light_tex, 6, x, red_y, 255, 50, 50);
+        else if(s == LIGHT_YELLOW) draw_circle(ren, light_tex, 6, x, yellow_y, 255, 200, 0);
+        else if(s == LIGHT_GREEN) draw_circle(ren, light_tex, 6, x, green_y, 0, 255, 100);
     }
 
     // Draw lights at corners, positioned outside the road
@@ -452,54 +655,83 @@ void draw_traffic_lights(SDL_Renderer* ren) {
 }
 
 void draw_cars(SDL_Renderer* ren) {
-    for(int i=0; i<200; i++) {
-        Vehicle* v = &vehicles[i];
-        if(!v->active) continue;
-
-        // Color based on intent (Subtle UI)
-        if(v->intent == TURN_LEFT) SDL_SetRenderDrawColor(ren, 100, 150, 255, 255); // Blue tint
-        else if(v->intent == TURN_RIGHT) SDL_SetRenderDrawColor(ren, 255, 150, 100, 255); // Orange tint
-        else SDL_SetRenderDrawColor(ren, 220, 220, 220, 255); // White
-
-        // Manual Rotation Render
-        float hw = VEHICLE_W / 2.0f;
-        float hl = VEHICLE_L / 2.0f;
-        
-        float c = cos(v->angle);
-        float s = sin(v->angle);
-        
-        // 4 Corners of the rectangle
-        float p1x = -hl * c - -hw * s + v->x; float p1y = -hl * s + -hw * c + v->y;
-        float p2x =  hl * c - -hw * s + v->x; float p2y =  hl * s + -hw * c + v->y;
-        float p3x =  hl * c -  hw * s + v->x; float p3y =  hl * s +  hw * c + v->y;
-        float p4x = -hl * c -  hw * s + v->x; float p4y = -hl * s +  hw * c + v->y;
-
-        // Draw basic quad using lines
-        SDL_RenderDrawLine(ren, p1x, p1y, p2x, p2y);
-        SDL_RenderDrawLine(ren, p2x, p2y, p3x, p3y);
-        SDL_RenderDrawLine(ren, p3x, p3y, p4x, p4y);
-        SDL_RenderDrawLine(ren, p4x, p4y, p1x, p1y);
-        
-        // Fill (inefficient but works for minimal cars)
-        SDL_Rect r = { (int)(v->x - 6), (int)(v->y - 6), 12, 12 };
-        SDL_RenderFillRect(ren, &r);
+    // Color based on intent (Subtle UI), indexed by TurnIntent
+    static const SDL_Color intent_color[3] = {
+        {100, 150, 255, 255}, // Left: blue tint
+        {220, 220, 220, 255}, // Straight: white
+        {255, 150, 100, 255}  // Right: orange tint
+    };
+
+    if(cars.count == 0) return;
+    if(car_batch_cap < cars.capacity) {
+        // The index pattern never changes, so it is only written when growing
+        car_verts = grow_array(car_verts, sizeof(SDL_Vertex), cars.capacity * 4);
+        car_index = grow_array(car_index, sizeof(int), cars.capacity * 6);
+        for(int i = car_batch_cap; i < cars.capacity; i++) {
+            int* q = &car_index[i * 6];
+            q[0] = i*4; q[1] = i*4 + 1; q[2] = i*4 + 2;
+            q[3] = i*4; q[4] = i*4 + 2; q[5] = i*4 + 3;
+        }
+        car_batch_cap = cars.capacity;
+    }
+
+    // Manual Rotation Render: the 4 corners of each rectangle
+    float hw = VEHICLE_W / 2.0f;
+    float hl = VEHICLE_L / 2.0f;
+    for(int i=0; i<cars.count; i++) {
+        float x = cars.x[i];
+        float y = cars.y[i];
+        float c = cars.hx[i];
+        float s = cars.hy[i];
+        SDL_Vertex* v = &car_verts[i * 4];
+        v[0].position.x = -hl * c - -hw * s + x; v[0].position.y = -hl * s + -hw * c + y;
+        v[1].position.x =  hl * c - -hw * s + x; v[1].position.y =  hl * s + -hw * c + y;
+        v[2].position.x =  hl * c -  hw * s + x; v[2].position.y =  hl * s +  hw * c + y;
+        v[3].position.x = -hl * c -  hw * s + x; v[3].position.y = -hl * s +  hw * c + y;
+        for(int k=0; k<4; k++) v[k].color = intent_color[cars.intent[i]];
     }
+    SDL_RenderGeometry(ren, NULL, car_verts, cars.count * 4, car_index, cars.count * 6);
 }
 
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
+    int stress = 0; // cars to start with
+    int cache_road = 1;
+    for(int i=1; i<argc; i++) {
+        if(strcmp(argv[i], "--stress") == 0 && i + 1 < argc) stress = atoi(argv[++i]);
+        else if(strcmp(argv[i], "--no-road-cache") == 0) cache_road = 0;
+        else {
+            fprintf(stderr, "Usage: %s [--stress N] [--no-road-cache]\n", argv[0]);
+            return 1;
+        }
+    }
     srand(time(NULL));
+    scatter_vehicles(stress);
     if(SDL_Init(SDL_INIT_VIDEO) < 0) return 1;
     
     SDL_Window* win = SDL_CreateWindow("Minimal Traffic Sim", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT, 0);
-    SDL_Renderer* ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    SDL_Renderer* ren = win ? SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC) : NULL;
+    if(ren == NULL) {
+        fprintf(stderr, "SDL window/renderer creation failed: %s\n", SDL_GetError());
+        if(win) SDL_DestroyWindow(win);
+        SDL_Quit();
+        return 1;
+    }
+    // Without render targets the road is drawn directly every frame
+    if(!SDL_RenderTargetSupported(ren)) cache_road = 0;
+    create_textures(ren);
 
     int running = 1;
     SDL_Event e;
+    Uint64 render_ticks = 0; // time spent rendering since the last report
 
     while(running) {
-        while(SDL_PollEvent(&e)) { if(e.type == SDL_QUIT) running = 0; }
+        while(SDL_PollEvent(&e)) {
+            if(e.type == SDL_QUIT) running = 0;
+            // Target contents are lost on a targets reset; a resize also means a redraw
+            else if(e.type == SDL_RENDER_TARGETS_RESET) road_dirty = 1;
+            else if(e.type == SDL_RENDER_DEVICE_RESET) create_textures(ren);
+            else if(e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) road_dirty = 1;
+        }
 
         // Logic
         if(frame % 80 == 0) spawn_vehicle(); // Reduced spawning frequency
@@ -507,19 +739,86 @@ int main(int argc, char* argv[]) {
         update_vehicles();
 
         // Render
-        SDL_SetRenderDrawColor(ren, 180, 180, 180, 255); // Gray background
-        SDL_RenderClear(ren);
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        if(road_dirty && cache_road) cache_road = build_road_layer(ren);
+        if(cache_road) SDL_RenderCopy(ren, road_layer, NULL, NULL);
+        else draw_background(ren);
 
-        draw_minimal_road(ren);
         draw_traffic_lights(ren);
         draw_cars(ren);
+        render_ticks += SDL_GetPerformanceCounter() - t0; // before Present, which waits for vsync
 
         SDL_RenderPresent(ren);
         frame++;
+
+        if(frame % FRAME_STATS_INTERVAL == 0) {
+            char title[128];
+            double ms = render_ticks * 1000.0 / SDL_GetPerformanceFrequency() / FRAME_STATS_INTERVAL;
+            snprintf(title, sizeof(title), "Minimal Traffic Sim - %d cars, render %.3f ms/frame (road %s)", cars.count, ms,
+                     cache_road ? "cached" : "redrawn");
+            SDL_SetWindowTitle(win, title);
+            render_ticks = 0;
+        }
     }
 
+    if(road_layer) SDL_DestroyTexture(road_layer);
+    if(light_tex) SDL_DestroyTexture(light_tex);
+    if(dot_tex) SDL_DestroyTexture(dot_tex);
+    free(car_verts);
+    free(car_index);
     SDL_DestroyRenderer(ren);
     SDL_DestroyWindow(win);
     SDL_Quit();
     return 0;
-}
\ No newline at end of file
+}
+
+#else
+// --- HEADLESS BENCHMARK ---
+// make graphics_bench: the scene logic without SDL, timed on a stress scene.
+// Usage: ./graphics_bench [vehicles] [frames]
+
+double now_sec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 100000;
+    int frames = argc > 2 ? atoi(argv[2]) : 100;
+    if(count < 1 || frames < 1) {
+        fprintf(stderr, "Usage: %s [vehicles] [frames]\n", argv[0]);
+        return 1;
+    }
+    srand(1);
+    scatter_vehicles(count);
+
+    double t0 = now_sec();
+    long updated = 0;
+    for(int f=0; f<frames; f++) {
+        updated += cars.count;
+        update_traffic_lights();
+        update_vehicles();
+        frame++;
+    }
+    double secs = now_sec() - t0;
+    printf("%d vehicles, %d frames: %.3f ms/frame, %.1f ns/vehicle (%d still active)\n", count, frames,
+           secs * 1000 / frames, secs * 1e9 / updated, cars.count);
+
+    // The kinematics kernels alone, over a fresh scene
+    cars.count = 0;
+    cars.turning = 0;
+    scatter_vehicles(count);
+    for(int i=0; i<cars.count; i++) cars.speed[i] = SPEED;
+    t0 = now_sec();
+    for(int f=0; f<frames; f++) drive_kernel(0, cars.count);
+    double drive = now_sec() - t0;
+    for(int i=0; i<cars.count; i++) start_turn(i, WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f);
+    t0 = now_sec();
+    for(int f=0; f<frames; f++) turn_kernel(cars.count);
+    double turn = now_sec() - t0;
+    printf("kernels: drive %.2f ns/vehicle, turn %.2f ns/vehicle\n", drive * 1e9 / ((double)frames * count),
+           turn * 1e9 / ((double)frames * count));
+    return 0;
+}
+#endif
@@ -0,0 +1,281 @@
+#include "grid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define GRID_DRAIN_BATCH 64
+
+typedef struct {
+    Grid* g;
+    int shard;
+    unsigned int first_tick;
+    unsigned int last_tick;
+    pthread_barrier_t* barrier;
+} GridWorker;
+
+// Stateless 32-bit hash: all random choices derive from it
+static unsigned int mix32(unsigned int x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+// 60% straight on, 20% left, 20% right
+static TurnIntent pickIntent(unsigned int h) {
+    unsigned int r = h % 10;
+    return r < 2 ? INTENT_LEFT : r < 4 ? INTENT_RIGHT : INTENT_STRAIGHT;
+}
+
+// Direction of travel after the turn (directions run clockwise N, E, S, W)
+static Direction headingAfter(Direction heading, TurnIntent intent) {
+    if (intent == INTENT_LEFT) return (Direction)((heading + 3) % 4);
+    if (intent == INTENT_RIGHT) return (Direction)((heading + 1) % 4);
+    return heading;
+}
+
+static SpscRing* createHandoffRing(int capacity) {
+    SpscRing* r = (SpscRing*)aligned_alloc(CACHE_LINE_SIZE, sizeof(SpscRing));
+    if (r == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    initSpscRing(r, capacity, sizeof(GridMove));
+    return r;
+}
+
+static void freeHandoffRing(SpscRing* r) {
+    if (r == NULL) return;
+    freeSpscRing(r);
+    free(r);
+}
+
+// Create a rows x cols grid split into at most `shards` row bands
+Grid* createGrid(int rows, int cols, int shards, unsigned int spawn_permille) {
+    if (shards > rows) shards = rows;
+    if (shards < 1) shards = 1;
+    Grid* g = (Grid*)malloc(sizeof(Grid));
+    Intersection* cells = (Intersection*)malloc(sizeof(Intersection) * rows * cols);
+    int* spawn_count = (int*)calloc(rows * cols, sizeof(int));
+    GridShard* bands = (GridShard*)calloc(shards, sizeof(GridShard));
+    if (g == NULL || cells == NULL || spawn_count == NULL || bands == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (int i = 0; i < rows * cols; i++) {
+        initIntersection(&cells[i], GREEN_TIME * 1000);
+    }
+
+    // At most DISPATCH_CAPACITY vehicles pass a junction per tick, so one
+    // tick of traffic across a band edge always fits
+    int handoff_capacity = cols * DISPATCH_CAPACITY;
+    for (int s = 0; s < shards; s++) {
+        GridShard* sh = &bands[s];
+        sh->first_row = rows * s / shards;
+        sh->end_row = rows * (s + 1) / shards;
+        for (int p = 0; p < 2; p++) {
+            sh->from_above[p] = s > 0 ? createHandoffRing(handoff_capacity) : NULL;
+            sh->from_below[p] = s < shards - 1 ? createHandoffRing(handoff_capacity) : NULL;
+        }
+        sh->local_moves = (GridMove*)malloc(sizeof(GridMove) * (sh->end_row - sh->first_row) * handoff_capacity);
+        if (sh->local_moves == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        initWaitHistogram(&sh->waits);
+    }
+
+    g->rows = rows;
+    g->cols = cols;
+    g->cells = cells;
+    g->spawn_count = spawn_count;
+    g->shard_count = shards;
+    g->shards = bands;
+    g->spawn_permille = spawn_permille;
+    g->now_ms = 0;
+    return g;
+}
+
+static void joinLane(Grid* g, const GridMove* m, unsigned int now_ms) {
+    Vehicle v = m->vehicle;
+    v.arrival_ms = now_ms;
+    enqueue(g->cells[m->dest].lanes[v.lane], v);
+}
+
+static void drainHandoffs(Grid* g, SpscRing* r, unsigned int now_ms) {
+    if (r == NULL) return;
+    unsigned int n;
+    while ((n = spscRingReadable(r, GRID_DRAIN_BATCH)) > 0) {
+        unsigned int head = spscRingHead(r);
+        for (unsigned int k = 0; k < n; k++) joinLane(g, (GridMove*)spscRingSlot(r, head + k), now_ms);
+        spscRingRelease(r, n);
+    }
+}
+
+static void handOff(SpscRing* r, const GridMove* m) {
+    GridMove* slot = (GridMove*)spscRingClaim(r);
+    if (slot == NULL) {
+        fprintf(stderr, "Grid handoff ring full\n");
+        exit(1);
+    }
+    *slot = *m;
+    spscRingPublish(r);
+}
+
+// Send a vehicle that just passed `cell` on towards its next junction
+static void route(Grid* g, GridShard* sh, int shard, int cell, Vehicle v, unsigned int tick) {
+    Direction heading = headingAfter((Direction)v.direction, (TurnIntent)v.intent);
+    int row = cell / g->cols;
+    int col = cell % g->cols;
+    switch (heading) {
+        case DIR_NORTH: row--; break;
+        case DIR_EAST:  col++; break;
+        case DIR_SOUTH: row++; break;
+        case DIR_WEST:  col--; break;
+    }
+    if (row < 0 || row >= g->rows || col < 0 || col >= g->cols) {
+        sh->exited++;
+        return;
+    }
+
+    // Ids are only unique per spawning junction, so the junction just
+    // passed and the tick go into the hash as well
+    GridMove m;
+    m.dest = row * g->cols + col;
+    m.vehicle = v;
+    m.vehicle.lane = (unsigned char)laneForHeading(heading);
+    m.vehicle.direction = (unsigned char)heading;
+    m.vehicle.intent = (unsigned char)pickIntent(mix32((unsigned int)v.id * 0x9e3779b9U ^
+                                                       (unsigned int)cell * 0x85ebca6bU ^ tick));
+    if (row < sh->first_row) {
+        handOff(g->shards[shard - 1].from_below[tick & 1], &m);
+    } else if (row >= sh->end_row) {
+        handOff(g->shards[shard + 1].from_above[tick & 1], &m);
+    } else {
+        sh->local_moves[sh->local_count++] = m;
+    }
+}
+
+// One tick for one band: take in last tick's moves, then update every junction
+static void stepShard(Grid* g, int shard, unsigned int tick) {
+    GridShard* sh = &g->shards[shard];
+    unsigned int now_ms = tick * GRID_TICK_MS;
+    unsigned int parity = (tick - 1) & 1;
+
+    for (int k = 0; k < sh->local_count; k++) joinLane(g, &sh->local_moves[k], now_ms);
+    sh->local_count = 0;
+    drainHandoffs(g, sh->from_above[parity], now_ms);
+    drainHandoffs(g, sh->from_below[parity], now_ms);
+
+    int end = sh->end_row * g->cols;
+    for (int cell = sh->first_row * g->cols; cell < end; cell++) {
+        Intersection* ix = &g->cells[cell];
+
+        unsigned int h = mix32((unsigned int)cell * 0x9e3779b9U ^ tick * 0x85ebca6bU);
+        if (h % 1000 < g->spawn_permille) {
+            Vehicle v;
+            memset(&v, 0, sizeof(v));
+            v.id = g->spawn_count[cell]++; // at most one per tick, so this never wraps in practice
+            v.lane = (unsigned char)((h >> 10) % NUM_LANES);
+            v.direction = (unsigned char)lane_directions[v.lane];
+            v.intent = (unsigned char)pickIntent(h >> 12);
+            v.arrival_ms = now_ms;
+            enqueue(ix->lanes[v.lane], v);
+            sh->spawned++;
+        }
+
+        if (now_ms >= ix->light_change_at) changeLight(ix, now_ms);
+        if (ix->light != GREEN) continue;
+
+        Vehicle passed[DISPATCH_CAPACITY];
+        DispatchResult d = dispatchIntersection(ix, now_ms, passed);
+        for (int k = 0; k < d.passed; k++) {
+            recordDeparture(&sh->waits, &passed[k]);
+            route(g, sh, shard, cell, passed[k], tick);
+        }
+        gapOut(ix, now_ms);
+    }
+}
+
+static void* gridWorker(void* arg) {
+    GridWorker* w = (GridWorker*)arg;
+    for (unsigned int tick = w->first_tick; tick <= w->last_tick; tick++) {
+        stepShard(w->g, w->shard, tick);
+        pthread_barrier_wait(w->barrier);
+    }
+    return NULL;
+}
+
+// Advance the whole grid by duration_ms, one thread per band
+void runGrid(Grid* g, unsigned int duration_ms) {
+    unsigned int first_tick = g->now_ms / GRID_TICK_MS + 1;
+    unsigned int last_tick = (g->now_ms + duration_ms) / GRID_TICK_MS;
+    if (last_tick < first_tick) return;
+
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned int)g->shard_count);
+    GridWorker* workers = (GridWorker*)malloc(sizeof(GridWorker) * g->shard_count);
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * g->shard_count);
+    if (workers == NULL || threads == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (int s = 0; s < g->shard_count; s++) {
+        GridWorker w = {g, s, first_tick, last_tick, &barrier};
+        workers[s] = w;
+    }
+    // Band 0 runs on the calling thread
+    for (int s = 1; s < g->shard_count; s++) {
+        pthread_create(&threads[s], NULL, gridWorker, &workers[s]);
+    }
+    gridWorker(&workers[0]);
+    for (int s = 1; s < g->shard_count; s++) {
+        pthread_join(threads[s], NULL);
+    }
+    pthread_barrier_destroy(&barrier);
+    free(workers);
+    free(threads);
+    g->now_ms = last_tick * GRID_TICK_MS;
+}
+
+// Totals across bands; vehicles between junctions count as queued
+void getGridStats(Grid* g, GridStats* out) {
+    memset(out, 0, sizeof(*out));
+    initWaitHistogram(&out->waits);
+    for (int s = 0; s < g->shard_count; s++) {
+        GridShard* sh = &g->shards[s];
+        out->spawned += sh->spawned;
+        out->exited += sh->exited;
+        out->queued += sh->local_count;
+        for (int p = 0; p < 2; p++) {
+            if (sh->from_above[p]) out->queued += spscRingSize(sh->from_above[p]);
+            if (sh->from_below[p]) out->queued += spscRingSize(sh->from_below[p]);
+        }
+        mergeWaitHistogram(&out->waits, &sh->waits);
+    }
+    for (int i = 0; i < g->rows * g->cols; i++) {
+        for (int l = 0; l < NUM_LANES; l++) out->queued += getSize(g->cells[i].lanes[l]);
+    }
+    out->intersection_ticks = (long)g->rows * g->cols * (g->now_ms / GRID_TICK_MS);
+}
+
+void freeGrid(Grid* g) {
+    for (int i = 0; i < g->rows * g->cols; i++) {
+        freeIntersection(&g->cells[i]);
+    }
+    for (int s = 0; s < g->shard_count; s++) {
+        GridShard* sh = &g->shards[s];
+        for (int p = 0; p < 2; p++) {
+            freeHandoffRing(sh->from_above[p]);
+            freeHandoffRing(sh->from_below[p]);
+        }
+        free(sh->local_moves);
+    }
+    free(g->cells);
+    free(g->spawn_count);
+    free(g->shards);
+    free(g);
+}
@@ -0,0 +1,66 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include "queue.h"
+#include "intersection.h"
+#include "spsc_ring.h"
+#include "wait_stats.h"
+
+// N x M city grid of intersections. A vehicle that passes a light drives on
+// to the neighbouring junction in the direction it ends up travelling and
+// joins the lane facing back the way it came; at the edge it leaves the grid.
+//
+// The grid is split into bands of whole rows, one per worker thread. Every
+// tick each worker updates its own intersections; vehicles moving into a
+// neighbouring band go through a lock-free SPSC ring between the two
+// workers, so the only synchronisation is one barrier per tick. A move
+// always takes effect on the next tick and every random choice is a hash of
+// the vehicle/junction/tick, so results do not depend on the thread count.
+
+#define GRID_TICK_MS 1000
+
+// A vehicle on its way to the next junction
+typedef struct {
+    Vehicle vehicle;
+    int dest;                       // index of the cell it is driving to
+} GridMove;
+
+typedef struct {
+    int first_row;                  // rows [first_row, end_row)
+    int end_row;
+    SpscRing* from_above[2];        // GridMoves from the band above, by tick parity
+    SpscRing* from_below[2];        // GridMoves from the band below, by tick parity
+    GridMove* local_moves;          // moves inside the band, applied next tick
+    int local_count;
+    long spawned;
+    long exited;
+    WaitHistogram waits;            // per-junction waits of vehicles served here
+} GridShard;
+
+typedef struct {
+    int rows;
+    int cols;
+    Intersection* cells;            // rows * cols, row-major
+    int* spawn_count;               // vehicles spawned per cell, their ids
+    int shard_count;
+    GridShard* shards;
+    unsigned int spawn_permille;    // chance per junction per tick of a new vehicle
+    unsigned int now_ms;            // simulation time reached
+} Grid;
+
+// Totals across all shards
+typedef struct {
+    long spawned;
+    long exited;
+    long queued;                    // still waiting at some junction
+    long intersection_ticks;        // junction updates performed
+    WaitHistogram waits;
+} GridStats;
+
+// Function prototypes
+Grid* createGrid(int rows, int cols, int shards, unsigned int spawn_permille);
+void runGrid(Grid* g, unsigned int duration_ms);
+void getGridStats(Grid* g, GridStats* out);
+void freeGrid(Grid* g);
+
+#endif // GRID_H
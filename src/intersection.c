@@ -0,0 +1,183 @@
+#include "intersection.h"
+#include <string.h>
+
+const Direction lane_directions[NUM_LANES] = {
+    DIR_SOUTH,  // A: from the north road
+    DIR_WEST,   // B: from the east road
+    DIR_NORTH,  // C: from the south road
+    DIR_EAST    // D: from the west road
+};
+
+// Start with the light GREEN until first_change_ms, proportional service and
+// the default priority lane rule
+void initIntersection(Intersection* ix, unsigned int first_change_ms) {
+    for (int i = 0; i < NUM_LANES; i++) {
+        ix->lanes[i] = createQueue();
+    }
+    ix->light = GREEN;
+    ix->light_change_at = first_change_ms;
+    ix->priority_lane = -1;
+    ix->priority = defaultPriorityRule();
+    initLaneScheduler(&ix->scheduler, SCHED_PROPORTIONAL);
+    memset(&ix->phase, 0, sizeof(ix->phase));
+    ix->phase.discharge_rate = (double)NUM_LANES / VEHICLE_PASS_TIME;
+}
+
+// Switch from the fixed cycle to queue-driven green phases
+void setAdaptiveTiming(Intersection* ix, unsigned int min_green_ms, unsigned int max_green_ms) {
+    ix->phase.adaptive = 1;
+    ix->phase.min_green_ms = min_green_ms;
+    ix->phase.max_green_ms = max_green_ms > min_green_ms ? max_green_ms : min_green_ms;
+}
+
+void freeIntersection(Intersection* ix) {
+    for (int i = 0; i < NUM_LANES; i++) {
+        freeQueue(ix->lanes[i]);
+    }
+}
+
+int intersectionWaiting(const Intersection* ix) {
+    for (int i = 0; i < NUM_LANES; i++) {
+        if (!isEmpty(ix->lanes[i])) return 1;
+    }
+    return 0;
+}
+
+#define DISCHARGE_EWMA 0.25   // weight of the newest green phase in the rate
+
+static int totalWaiting(const Intersection* ix) {
+    int total = 0;
+    for (int i = 0; i < NUM_LANES; i++) total += getSize(ix->lanes[i]);
+    return total;
+}
+
+// Green time to clear waiting vehicles at the measured rate, in whole
+// dispatch slots so the phase covers its last vehicle
+static unsigned int greenFor(const PhaseControl* pc, int waiting) {
+    double slots = waiting / pc->discharge_rate * 1000.0 / DISPATCH_SLOT_MS;
+    unsigned int green_ms = ((unsigned int)slots + 1) * DISPATCH_SLOT_MS;
+    if (green_ms < pc->min_green_ms) green_ms = pc->min_green_ms;
+    if (green_ms > pc->max_green_ms) green_ms = pc->max_green_ms;
+    return green_ms;
+}
+
+// Flip the light and plan the next change. An adaptive junction extends a
+// green that still has vehicles waiting (up to its maximum), and with nobody
+// waiting stays RED and rests instead (see demandGreen).
+LightState changeLight(Intersection* ix, unsigned int now_ms) {
+    PhaseControl* pc = &ix->phase;
+    if (ix->light == GREEN) {
+        unsigned int max_end = pc->green_started_at + pc->max_green_ms;
+        int waiting = totalWaiting(ix);
+        if (pc->adaptive && waiting > 0 && now_ms < max_end) {
+            unsigned int extend = greenFor(pc, waiting);
+            ix->light_change_at = now_ms + extend < max_end ? now_ms + extend : max_end;
+            return GREEN;
+        }
+        if (pc->busy_slots > 0) {
+            double observed = pc->passed * 1000.0 / ((double)pc->busy_slots * DISPATCH_SLOT_MS);
+            pc->discharge_rate += DISCHARGE_EWMA * (observed - pc->discharge_rate);
+        }
+        ix->light = RED;
+        ix->light_change_at = now_ms + RED_TIME * 1000;
+        return RED;
+    }
+
+    unsigned int green_ms = GREEN_TIME * 1000;
+    if (pc->adaptive) {
+        int waiting = totalWaiting(ix);
+        if (waiting == 0) {
+            pc->resting = 1;
+            ix->light_change_at = now_ms;
+            return RED;
+        }
+        green_ms = greenFor(pc, waiting);
+    }
+    pc->resting = 0;
+    pc->green_started_at = now_ms;
+    pc->passed = 0;
+    pc->busy_slots = 0;
+    pc->last_busy_at = now_ms;
+    ix->light = GREEN;
+    ix->light_change_at = now_ms + green_ms;
+    return GREEN;
+}
+
+// A vehicle reached a resting junction: plan the green phase for at_ms.
+// Returns 1 if the caller now has a light change to schedule.
+int demandGreen(Intersection* ix, unsigned int at_ms) {
+    if (!ix->phase.resting) return 0;
+    ix->phase.resting = 0;
+    ix->light_change_at = at_ms;
+    return 1;
+}
+
+// Adaptive: once the lanes have been empty for GAP_TIME, bring the end of
+// the green phase forward (never before its minimum). Returns 1 if it moved.
+int gapOut(Intersection* ix, unsigned int now_ms) {
+    PhaseControl* pc = &ix->phase;
+    if (!pc->adaptive || ix->light != GREEN || totalWaiting(ix) > 0) return 0;
+    unsigned int end = pc->green_started_at + pc->min_green_ms;
+    if (end < pc->last_busy_at + GAP_TIME * 1000) end = pc->last_busy_at + GAP_TIME * 1000;
+    if (end < now_ms) end = now_ms;
+    if (end >= ix->light_change_at) return 0;
+    ix->light_change_at = end;
+    return 1;
+}
+
+// Let up to max vehicles pass from a lane into out; returns how many did
+static int passFrom(Intersection* ix, int lane, int max, unsigned int now_ms, Vehicle* out) {
+    int n = dequeueBatch(ix->lanes[lane], out, max);
+    for (int k = 0; k < n; k++) out[k].departure_ms = now_ms;
+    return n;
+}
+
+// One green-phase dispatch slot. Passed vehicles (at most DISPATCH_CAPACITY)
+// are written to out with departure_ms set.
+DispatchResult dispatchIntersection(Intersection* ix, unsigned int now_ms, Vehicle out[DISPATCH_CAPACITY]) {
+    DispatchResult r;
+    memset(&r, 0, sizeof(r));
+    r.to_serve = -1;
+    if (totalWaiting(ix) > 0) {
+        ix->phase.busy_slots++;
+        ix->phase.last_busy_at = now_ms;
+    }
+
+    // The priority lane takes over once it is long enough...
+    const PriorityRule* rule = &ix->priority;
+    if (rule->lane >= 0 && ix->priority_lane == -1 && getSize(ix->lanes[rule->lane]) > rule->enter_above) {
+        ix->priority_lane = rule->lane;
+        r.priority_on = 1;
+        r.priority_size = getSize(ix->lanes[rule->lane]);
+    }
+
+    // ...and is served alone until it is short again
+    if (ix->priority_lane != -1) {
+        int per_slot = rule->per_slot < DISPATCH_CAPACITY ? rule->per_slot : DISPATCH_CAPACITY;
+        r.from_priority = 1;
+        r.passed = passFrom(ix, ix->priority_lane, per_slot, now_ms, out);
+        ix->phase.passed += r.passed;
+        if (getSize(ix->lanes[ix->priority_lane]) < rule->leave_below) {
+            r.priority_off = 1;
+            ix->priority_lane = -1;
+        }
+        return r;
+    }
+
+    // Normal condition: the policy splits the slot between lanes
+    int lengths[NUM_LANES];
+    int take[NUM_LANES] = {0};
+    for (int i = 0; i < NUM_LANES; i++) lengths[i] = getSize(ix->lanes[i]);
+    r.to_serve = ix->scheduler.plan(&ix->scheduler, lengths, DISPATCH_CAPACITY, take);
+    for (int i = 0; i < NUM_LANES; i++) {
+        if (take[i] > 0) r.passed += passFrom(ix, i, take[i], now_ms, out + r.passed);
+    }
+    ix->phase.passed += r.passed;
+    return r;
+}
+
+// Lane a vehicle joins when it reaches a junction travelling this way
+// (inverse of lane_directions)
+int laneForHeading(Direction heading) {
+    return (heading + 2) % NUM_LANES;
+}
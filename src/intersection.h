@@ -0,0 +1,75 @@
+#ifndef INTERSECTION_H
+#define INTERSECTION_H
+
+#include "queue.h"
+#include "scheduler.h"
+
+#define GREEN_TIME 10    // seconds for green light
+#define RED_TIME 5       // seconds for red light
+#define VEHICLE_PASS_TIME 2  // seconds per vehicle in each lane (before any is measured)
+#define MIN_GREEN_TIME 3     // adaptive green phase bounds, seconds
+#define MAX_GREEN_TIME 30
+#define GAP_TIME 3           // adaptive green ends after this long with empty lanes
+#define DISPATCH_SLOT_MS 1000        // vehicles cross in whole-second slots
+#define DISPATCH_CAPACITY NUM_LANES  // vehicles that can cross in one dispatch slot
+
+typedef enum {
+    RED,
+    GREEN
+} LightState;
+
+// Direction of travel for vehicles approaching on each lane
+extern const Direction lane_directions[NUM_LANES];
+
+// Adaptive green timing. A green phase lasts |V| x t: the vehicles waiting
+// when it starts divided by the measured discharge rate, at least
+// min_green_ms. It is extended the same way while vehicles are still
+// waiting, up to max_green_ms in total, ends early once every lane has been
+// empty for GAP_TIME, and is skipped altogether when nobody is waiting (the
+// light rests on RED until a vehicle arrives).
+typedef struct {
+    int adaptive;                   // 0: fixed GREEN_TIME / RED_TIME cycle
+    int resting;                    // RED with no demand; no change is scheduled
+    unsigned int min_green_ms;
+    unsigned int max_green_ms;
+    unsigned int green_started_at;
+    double discharge_rate;          // vehicles per second of busy green (EWMA)
+    int passed;                     // vehicles passed in the current green
+    int busy_slots;                 // its dispatch slots that had vehicles waiting
+    unsigned int last_busy_at;      // last of those slots
+} PhaseControl;
+
+// One junction: four approach lanes sharing one light. All state the
+// scheduling rules need lives here, so a simulation can own any number.
+typedef struct {
+    Queue* lanes[NUM_LANES];
+    LightState light;
+    unsigned int light_change_at;   // simulation ms of the next light change
+    int priority_lane;              // -1 means none
+    PriorityRule priority;
+    LaneScheduler scheduler;        // normal-condition policy
+    PhaseControl phase;
+} Intersection;
+
+// What one dispatch slot did, so callers can report it in order
+typedef struct {
+    int priority_on;      // priority.lane just became the priority lane
+    int priority_size;    // its size at that moment
+    int priority_off;     // the priority lane just dropped below priority.leave_below
+    int from_priority;    // the vehicles that passed came from the priority lane
+    int to_serve;         // what the policy aimed to serve (-1 when priority-served)
+    int passed;           // vehicles written to the out array
+} DispatchResult;
+
+// Function prototypes
+void initIntersection(Intersection* ix, unsigned int first_change_ms);
+void freeIntersection(Intersection* ix);
+int intersectionWaiting(const Intersection* ix);
+void setAdaptiveTiming(Intersection* ix, unsigned int min_green_ms, unsigned int max_green_ms);
+LightState changeLight(Intersection* ix, unsigned int now_ms);
+int demandGreen(Intersection* ix, unsigned int at_ms);
+int gapOut(Intersection* ix, unsigned int now_ms);
+DispatchResult dispatchIntersection(Intersection* ix, unsigned int now_ms, Vehicle out[DISPATCH_CAPACITY]);
+int laneForHeading(Direction heading);
+
+#endif // INTERSECTION_H
@@ -0,0 +1,247 @@
+#include "lane_ingest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#define INGEST_READ_CHUNK 4096
+
+static void openTail(LaneTail* t) {
+    if (t->fd >= 0) return;
+    t->fd = open(t->path, O_RDWR);
+    if (t->fd < 0) t->fd = open(t->path, O_RDONLY); // enough for counting
+    t->offset = 0;
+    t->partial_len = 0;
+    t->lines = 0;
+}
+
+// Watch the directory holding the lane files: this also catches files that
+// are created or truncated after we start
+static void setupNotify(LaneIngest* in) {
+    in->notify_fd = -1;
+#ifdef __linux__
+    if (in->count == 0) return;
+    char dir[256];
+    const char* slash = strrchr(in->lanes[0].path, '/');
+    if (slash) {
+        snprintf(dir, sizeof(dir), "%.*s", (int)(slash - in->lanes[0].path), in->lanes[0].path);
+    } else {
+        strcpy(dir, ".");
+    }
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) return;
+    if (inotify_add_watch(fd, dir, IN_MODIFY | IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        close(fd);
+        return;
+    }
+    in->notify_fd = fd;
+#endif
+}
+
+void initLaneIngest(LaneIngest* in, const char* const* paths, int count) {
+    memset(in, 0, sizeof(*in));
+    in->count = count < INGEST_MAX_LANES ? count : INGEST_MAX_LANES;
+    for (int i = 0; i < in->count; i++) {
+        LaneTail* t = &in->lanes[i];
+        t->path = paths[i];
+        const char* slash = strrchr(paths[i], '/');
+        t->name = slash ? slash + 1 : paths[i];
+        t->fd = -1;
+        t->dirty = 1; // read whatever is already there
+        openTail(t);
+    }
+    setupNotify(in);
+}
+
+// Hand every complete line in buf to the handler; keep the unfinished tail
+static int splitLines(LaneTail* t, int lane, const char* buf, int len, LineHandler handler, void* ctx) {
+    int lines = 0;
+    const char* p = buf;
+    const char* end = buf + len;
+    while (p < end) {
+        const char* nl = memchr(p, '\n', end - p);
+        int chunk = (int)((nl ? nl : end) - p);
+        int room = INGEST_LINE_MAX - 1 - t->partial_len;
+        int copy = chunk < room ? chunk : room; // overlong lines are cut, not split
+        memcpy(t->partial + t->partial_len, p, copy);
+        t->partial_len += copy;
+        if (!nl) break;
+        t->partial[t->partial_len] = '\0';
+        handler(lane, t->partial, ctx);
+        t->partial_len = 0;
+        lines++;
+        p = nl + 1;
+    }
+    return lines;
+}
+
+// Truncate a fully consumed lane file while holding the generators' lock
+static void compactTail(LaneTail* t) {
+    if (flock(t->fd, LOCK_EX | LOCK_NB) != 0) return; // a generator is writing; try later
+    struct stat st;
+    if (fstat(t->fd, &st) == 0 && st.st_size == t->offset && t->partial_len == 0) {
+        if (ftruncate(t->fd, 0) == 0) t->offset = 0;
+    }
+    flock(t->fd, LOCK_UN);
+}
+
+// Read everything appended to one lane since the last call
+int ingestLane(LaneIngest* in, int lane, LineHandler handler, void* ctx) {
+    LaneTail* t = &in->lanes[lane];
+    t->dirty = 0;
+    openTail(t);
+    if (t->fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(t->fd, &st) != 0) return 0;
+    if (st.st_size < t->offset) {
+        // Truncated behind our back (a generator restarted with "w")
+        t->offset = 0;
+        t->partial_len = 0;
+    }
+
+    char buf[INGEST_READ_CHUNK];
+    int lines = 0;
+    for (;;) {
+        ssize_t n = pread(t->fd, buf, sizeof(buf), t->offset);
+        if (n <= 0) break;
+        t->offset += n;
+        lines += splitLines(t, lane, buf, (int)n, handler, ctx);
+    }
+    if (t->offset >= INGEST_COMPACT_BYTES) compactTail(t);
+    return lines;
+}
+
+// Drain pending inotify events and mark the lanes they name as dirty
+static void drainNotify(LaneIngest* in) {
+#ifdef __linux__
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+        ssize_t n = read(in->notify_fd, buf, sizeof(buf));
+        if (n <= 0) break;
+        for (char* p = buf; p < buf + n;) {
+            struct inotify_event* ev = (struct inotify_event*)p;
+            for (int i = 0; i < in->count; i++) {
+                if (ev->len && strcmp(ev->name, in->lanes[i].name) == 0) in->lanes[i].dirty = 1;
+            }
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+#else
+    (void)in;
+#endif
+}
+
+// Read the lanes that changed (every lane when there is no inotify)
+int ingestChanged(LaneIngest* in, LineHandler handler, void* ctx) {
+    if (in->notify_fd >= 0) drainNotify(in);
+    int lines = 0;
+    for (int i = 0; i < in->count; i++) {
+        if (in->notify_fd < 0 || in->lanes[i].dirty) lines += ingestLane(in, i, handler, ctx);
+    }
+    return lines;
+}
+
+// Sleep up to timeout_ms waiting for a lane file to change. Returns 1 when
+// something changed (call ingestChanged), 0 on timeout. Without inotify this
+// just sleeps and reports 0; callers poll with ingestChanged instead.
+int ingestWait(LaneIngest* in, int timeout_ms) {
+    if (in->notify_fd < 0) {
+        if (timeout_ms > 0) usleep(timeout_ms * 1000);
+        return 0;
+    }
+    struct pollfd pfd = {in->notify_fd, POLLIN, 0};
+    return poll(&pfd, 1, timeout_ms) > 0;
+}
+
+// Number of '\n' bytes in p[0..n). Compares 16 bytes at a time, keeping
+// per-byte tallies for up to 255 blocks before summing them.
+long countNewlines(const char* p, long n) {
+    long count = 0;
+    long i = 0;
+#ifdef __SSE2__
+    const __m128i nl = _mm_set1_epi8('\n');
+    while (n - i >= 16) {
+        long blocks = (n - i) / 16;
+        if (blocks > 255) blocks = 255;
+        __m128i tally = _mm_setzero_si128();
+        for (long b = 0; b < blocks; b++, i += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+            tally = _mm_sub_epi8(tally, _mm_cmpeq_epi8(v, nl)); // a match is -1
+        }
+        __m128i sums = _mm_sad_epu8(tally, _mm_setzero_si128());
+        count += _mm_extract_epi16(sums, 0) + _mm_extract_epi16(sums, 4);
+    }
+#endif
+    for (; i < n; i++) count += p[i] == '\n';
+    return count;
+}
+
+// Bring one lane's line count up to date and return it. Only bytes appended
+// since the last call are scanned; lines are never consumed.
+long countLane(LaneIngest* in, int lane) {
+    LaneTail* t = &in->lanes[lane];
+    t->dirty = 0;
+    openTail(t);
+    if (t->fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(t->fd, &st) != 0) return t->lines;
+    if (st.st_size < t->offset) {
+        // Truncated (compacted by the simulator or a generator restart)
+        t->offset = 0;
+        t->lines = 0;
+    }
+    long backlog = (long)st.st_size - t->offset;
+    if (backlog >= COUNT_MMAP_BYTES) {
+        // Cold start: scan the file in place instead of copying it
+        void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, t->fd, 0);
+        if (base != MAP_FAILED) {
+            madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+            t->lines += countNewlines((const char*)base + t->offset, backlog);
+            t->offset = (long)st.st_size;
+            munmap(base, (size_t)st.st_size);
+        }
+    }
+    char buf[INGEST_READ_CHUNK];
+    for (;;) {
+        ssize_t n = pread(t->fd, buf, sizeof(buf), t->offset);
+        if (n <= 0) break;
+        t->offset += n;
+        t->lines += countNewlines(buf, (long)n);
+    }
+    return t->lines;
+}
+
+// Recount the lanes that changed (every lane when there is no inotify).
+// Returns how many lane counts moved.
+int countChanged(LaneIngest* in) {
+    if (in->notify_fd >= 0) drainNotify(in);
+    int moved = 0;
+    for (int i = 0; i < in->count; i++) {
+        if (in->notify_fd >= 0 && !in->lanes[i].dirty) continue;
+        long before = in->lanes[i].lines;
+        if (countLane(in, i) != before) moved++;
+    }
+    return moved;
+}
+
+void closeLaneIngest(LaneIngest* in) {
+    for (int i = 0; i < in->count; i++) {
+        if (in->lanes[i].fd >= 0) close(in->lanes[i].fd);
+        in->lanes[i].fd = -1;
+    }
+    if (in->notify_fd >= 0) close(in->notify_fd);
+    in->notify_fd = -1;
+}
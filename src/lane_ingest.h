@@ -0,0 +1,52 @@
+#ifndef LANE_INGEST_H
+#define LANE_INGEST_H
+
+// Incremental reader for the lane files the traffic generators append to.
+// Each lane keeps an open descriptor and the byte offset it has consumed,
+// so a read only touches newly appended bytes; a trailing line without its
+// newline is held back until the rest arrives. On Linux an inotify watch on
+// the data directory reports which lanes changed, so idle lanes cost nothing.
+//
+// Files are never truncated on every read. Once a lane has been consumed
+// past INGEST_COMPACT_BYTES it is truncated under an exclusive flock(), which
+// the generators also take while appending, so no vehicle can be lost.
+//
+// The receivers use the same watch to count the lines in each file without
+// consuming them: countLane() only scans bytes appended since its last call
+// (the whole file, memory-mapped, on a cold start or after a truncation).
+
+#define INGEST_MAX_LANES 8
+#define INGEST_LINE_MAX 256
+#define INGEST_COMPACT_BYTES (64 * 1024)
+#define COUNT_MMAP_BYTES (64 * 1024)    // map rather than read backlogs this big
+
+typedef void (*LineHandler)(int lane, const char* line, void* ctx);
+
+typedef struct {
+    const char* path;
+    const char* name;      // file name inside the watched directory
+    int fd;                // -1 until the file exists
+    long offset;           // bytes consumed so far
+    char partial[INGEST_LINE_MAX];
+    int partial_len;
+    int dirty;             // changed since last read
+    long lines;            // countLane(): newlines in the first offset bytes
+} LaneTail;
+
+typedef struct {
+    LaneTail lanes[INGEST_MAX_LANES];
+    int count;
+    int notify_fd;         // inotify descriptor, -1 when unavailable
+} LaneIngest;
+
+// Function prototypes
+void initLaneIngest(LaneIngest* in, const char* const* paths, int count);
+int ingestLane(LaneIngest* in, int lane, LineHandler handler, void* ctx);
+int ingestChanged(LaneIngest* in, LineHandler handler, void* ctx);
+int ingestWait(LaneIngest* in, int timeout_ms);
+long countLane(LaneIngest* in, int lane);
+int countChanged(LaneIngest* in);
+long countNewlines(const char* p, long n);
+void closeLaneIngest(LaneIngest* in);
+
+#endif // LANE_INGEST_H
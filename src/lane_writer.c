@@ -0,0 +1,83 @@
+#include "lane_writer.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+// Open (and optionally empty) every lane file. Returns 1 on error.
+int openLaneWriter(LaneWriter* w, const char* const* paths, int count, int truncate, unsigned int flush_ms) {
+    memset(w->lens, 0, sizeof(w->lens));
+    w->count = count < LANE_WRITER_MAX ? count : LANE_WRITER_MAX;
+    w->flush_ms = flush_ms;
+    w->last_flush_ms = 0;
+    w->writes = 0;
+    int flags = O_WRONLY | O_CREAT | O_APPEND | (truncate ? O_TRUNC : 0);
+    for (int i = 0; i < w->count; i++) {
+        w->fds[i] = open(paths[i], flags, 0644);
+        if (w->fds[i] < 0) {
+            perror(paths[i]);
+            while (--i >= 0) close(w->fds[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int flushLane(LaneWriter* w, int lane) {
+    int len = w->lens[lane];
+    if (len == 0) return 0;
+    int fd = w->fds[lane];
+    flock(fd, LOCK_EX);
+    int done = 0;
+    while (done < len) {
+        int n = (int)write(fd, w->bufs[lane] + done, len - done);
+        if (n <= 0) break;
+        done += n;
+    }
+    flock(fd, LOCK_UN);
+    w->lens[lane] = 0;
+    w->writes++;
+    if (done < len) {
+        perror("Error writing lane file");
+        return 1;
+    }
+    return 0;
+}
+
+// Queue one "<id>\n" line for a lane. Returns 1 if a write failed.
+int laneWriterAppend(LaneWriter* w, int lane, unsigned int id) {
+    if (w->lens[lane] > LANE_WRITE_BUFFER - 12 && flushLane(w, lane)) return 1;
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + id % 10);
+        id /= 10;
+    } while (id > 0);
+    char* p = w->bufs[lane] + w->lens[lane];
+    for (int i = 0; i < n; i++) p[i] = digits[n - 1 - i];
+    p[n] = '\n';
+    w->lens[lane] += n + 1;
+    if (w->flush_ms == 0) return flushLane(w, lane);
+    return 0;
+}
+
+// Call before waiting until next_ms: write out every lane unless what is
+// buffered can wait until then without exceeding the flush interval
+int laneWriterFlushDue(LaneWriter* w, unsigned int now_ms, unsigned int next_ms) {
+    if (next_ms - w->last_flush_ms < w->flush_ms) return 0;
+    w->last_flush_ms = now_ms;
+    return flushLaneWriter(w);
+}
+
+int flushLaneWriter(LaneWriter* w) {
+    int failed = 0;
+    for (int i = 0; i < w->count; i++) failed |= flushLane(w, i);
+    return failed;
+}
+
+void closeLaneWriter(LaneWriter* w) {
+    flushLaneWriter(w);
+    for (int i = 0; i < w->count; i++) close(w->fds[i]);
+    w->count = 0;
+}
@@ -0,0 +1,32 @@
+#ifndef LANE_WRITER_H
+#define LANE_WRITER_H
+
+// Buffered appender for the lane files, used by the traffic generators.
+// Every lane file stays open (O_APPEND) and vehicle ids are collected in a
+// per-lane buffer. A lane is written out in one write() when its buffer
+// fills, and every lane at least once per flush interval. Each write holds
+// the file's flock(), like the simulator's compaction (see lane_ingest.h),
+// so no vehicle is lost when a file is truncated.
+
+#define LANE_WRITER_MAX 8
+#define LANE_WRITE_BUFFER 8192
+#define LANE_FLUSH_MS 100    // default flush interval
+
+typedef struct {
+    int fds[LANE_WRITER_MAX];
+    int count;
+    char bufs[LANE_WRITER_MAX][LANE_WRITE_BUFFER];
+    int lens[LANE_WRITER_MAX];
+    unsigned int flush_ms;       // 0 = write every vehicle straight away
+    unsigned int last_flush_ms;
+    long writes;                 // write() calls made
+} LaneWriter;
+
+// Function prototypes
+int openLaneWriter(LaneWriter* w, const char* const* paths, int count, int truncate, unsigned int flush_ms);
+int laneWriterAppend(LaneWriter* w, int lane, unsigned int id);
+int laneWriterFlushDue(LaneWriter* w, unsigned int now_ms, unsigned int next_ms);
+int flushLaneWriter(LaneWriter* w);
+void closeLaneWriter(LaneWriter* w);
+
+#endif // LANE_WRITER_H
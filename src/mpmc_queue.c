@@ -0,0 +1,115 @@
+#include "mpmc_queue.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <sched.h>
+
+// A slot at index i is free for the producer whose position is pos when
+// sequence == pos, and holds a vehicle for the consumer at pos when
+// sequence == pos + 1. After consuming, the slot is recycled for the next
+// lap by setting sequence = pos + capacity.
+
+// Back off after this many failed CAS attempts so a crowd of generators
+// does not starve the thread holding the next slot
+#define MPMC_SPIN_LIMIT 64
+
+static unsigned int roundCapacity(int capacity) {
+    unsigned int slots = 2;
+    while (slots < (unsigned int)capacity) slots <<= 1;
+    return slots;
+}
+
+// Bytes needed to hold a queue of at least capacity vehicles
+size_t mpmcQueueBytes(int capacity) {
+    size_t bytes = sizeof(MpmcQueue) + sizeof(MpmcCell) * roundCapacity(capacity);
+    return (bytes + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+}
+
+// Lay out a queue in caller-provided, cache-line aligned memory
+MpmcQueue* initMpmcQueue(void* memory, int capacity) {
+    MpmcQueue* q = (MpmcQueue*)memory;
+    unsigned int slots = roundCapacity(capacity);
+    for (unsigned int i = 0; i < slots; i++) {
+        atomic_init(&q->cells[i].sequence, i);
+    }
+    atomic_init(&q->enqueue_pos, 0);
+    atomic_init(&q->dequeue_pos, 0);
+    q->mask = slots - 1;
+    return q;
+}
+
+// Create a heap-allocated queue
+MpmcQueue* createMpmcQueue(int capacity) {
+    void* memory = aligned_alloc(CACHE_LINE_SIZE, mpmcQueueBytes(capacity));
+    if (memory == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    return initMpmcQueue(memory, capacity);
+}
+
+// Any producer: append a vehicle, false if the ring is full
+bool mpmcEnqueue(MpmcQueue* q, Vehicle v) {
+    unsigned int pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    int spins = 0;
+    for (;;) {
+        MpmcCell* cell = &q->cells[pos & q->mask];
+        unsigned int seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        int diff = (int)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->vehicle = v;
+                atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+                return true;
+            }
+            if (++spins == MPMC_SPIN_LIMIT) {
+                spins = 0;
+                sched_yield();
+            }
+        } else if (diff < 0) {
+            return false; // slot still holds last lap's vehicle: full
+        } else {
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+// Any consumer: take the front vehicle, false if the ring is empty
+bool mpmcDequeue(MpmcQueue* q, Vehicle* out) {
+    unsigned int pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    int spins = 0;
+    for (;;) {
+        MpmcCell* cell = &q->cells[pos & q->mask];
+        unsigned int seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        int diff = (int)(seq - (pos + 1));
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *out = cell->vehicle;
+                atomic_store_explicit(&cell->sequence, pos + q->mask + 1, memory_order_release);
+                return true;
+            }
+            if (++spins == MPMC_SPIN_LIMIT) {
+                spins = 0;
+                sched_yield();
+            }
+        } else if (diff < 0) {
+            return false; // producer has not filled this slot yet: empty
+        } else {
+            pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+// Approximate number of queued vehicles
+int mpmcGetSize(MpmcQueue* q) {
+    unsigned int head = atomic_load_explicit(&q->dequeue_pos, memory_order_acquire);
+    unsigned int tail = atomic_load_explicit(&q->enqueue_pos, memory_order_acquire);
+    int size = (int)(tail - head);
+    return size < 0 ? 0 : size;
+}
+
+// Free a queue made by createMpmcQueue
+void freeMpmcQueue(MpmcQueue* q) {
+    free(q);
+}
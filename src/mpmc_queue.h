@@ -0,0 +1,44 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "queue.h"
+#include "cacheline.h"
+
+// Bounded multi-producer/multi-consumer lane queue (Vyukov's design).
+// Every slot carries a sequence number that tells producers and consumers
+// whether it is ready for them, so each operation is a single CAS on the
+// shared position followed by an uncontended slot write.
+//
+// The structure holds no pointers: it can live in ordinary heap memory or
+// in a MAP_SHARED mapping so several generator processes feed one lane.
+//
+// Library only, on purpose: every handoff inside the simulator has exactly
+// one producer and one consumer (the epoll ingest thread to the scheduler,
+// the scheduler to the reporter, one grid band to the next), where SpscRing
+// needs no CAS at all. This queue is for a front end with many producers,
+// such as generator processes sharing a mapping; test_mpmc and bench cover it.
+typedef struct {
+    atomic_uint sequence;
+    Vehicle vehicle;
+} MpmcCell;
+
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) atomic_uint enqueue_pos;
+    _Alignas(CACHE_LINE_SIZE) atomic_uint dequeue_pos;
+    _Alignas(CACHE_LINE_SIZE) unsigned int mask;
+    MpmcCell cells[];
+} MpmcQueue;
+
+// Function prototypes
+size_t mpmcQueueBytes(int capacity);
+MpmcQueue* initMpmcQueue(void* memory, int capacity);
+MpmcQueue* createMpmcQueue(int capacity);
+bool mpmcEnqueue(MpmcQueue* q, Vehicle v);
+bool mpmcDequeue(MpmcQueue* q, Vehicle* out);
+int mpmcGetSize(MpmcQueue* q);
+void freeMpmcQueue(MpmcQueue* q);
+
+#endif // MPMC_QUEUE_H
@@ -0,0 +1,237 @@
+#include "net_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "wire.h"
+
+#define NET_LISTEN_TAG 0xffffffffu
+#define NET_WAKE_TAG 0xfffffffeu
+#define NET_MAX_EVENTS 64
+
+_Static_assert(NET_CONN_BUFFER >= WIRE_MAX_FRAME, "a full binary frame must fit in a connection buffer");
+
+static int setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags < 0 ? -1 : fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// Start listening on port. Returns 0 on success, 1 on failure.
+int openNetServer(NetServer* srv, int port, int num_lanes) {
+    memset(srv, 0, sizeof(*srv));
+    srv->num_lanes = num_lanes;
+    srv->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv->listen_fd < 0) {
+        perror("socket() failed");
+        return 1;
+    }
+
+    /* set SO_REUSEADDR so restarting quickly doesn't fail bind */
+    int reuse = 1;
+    setsockopt(srv->listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (bind(srv->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "bind() failed on port %d: ", port);
+        perror("");
+        close(srv->listen_fd);
+        return 1;
+    }
+    if (listen(srv->listen_fd, SOMAXCONN) < 0 || setNonBlocking(srv->listen_fd) < 0) {
+        perror("listen() failed");
+        close(srv->listen_fd);
+        return 1;
+    }
+
+    srv->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev = {EPOLLIN, {.u32 = NET_LISTEN_TAG}};
+    srv->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event wake = {EPOLLIN, {.u32 = NET_WAKE_TAG}};
+    if (srv->epoll_fd < 0 || srv->wake_fd < 0 ||
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, srv->listen_fd, &ev) < 0 ||
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, srv->wake_fd, &wake) < 0) {
+        perror("epoll setup failed");
+        close(srv->listen_fd);
+        return 1;
+    }
+    return 0;
+}
+
+static void closeConn(NetServer* srv, unsigned int slot) {
+    NetConn* c = srv->conns[slot];
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    free(c);
+    srv->conns[slot] = NULL;
+    srv->clients--;
+}
+
+static void acceptClients(NetServer* srv) {
+    for (;;) {
+        int fd = accept(srv->listen_fd, NULL, NULL);
+        if (fd < 0) return; // EAGAIN: backlog drained
+        setNonBlocking(fd);
+
+        int slot = 0;
+        while (slot < srv->conn_capacity && srv->conns[slot] != NULL) slot++;
+        if (slot == srv->conn_capacity) {
+            int capacity = srv->conn_capacity ? srv->conn_capacity * 2 : 16;
+            NetConn** conns = (NetConn**)realloc(srv->conns, sizeof(NetConn*) * capacity);
+            if (conns == NULL) {
+                fprintf(stderr, "Memory allocation failed\n");
+                exit(1);
+            }
+            memset(conns + srv->conn_capacity, 0, sizeof(NetConn*) * (capacity - srv->conn_capacity));
+            srv->conns = conns;
+            srv->conn_capacity = capacity;
+        }
+        NetConn* c = (NetConn*)calloc(1, sizeof(NetConn));
+        if (c == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        c->fd = fd;
+        srv->conns[slot] = c;
+        srv->clients++;
+
+        struct epoll_event ev = {EPOLLIN | EPOLLRDHUP, {.u32 = (unsigned int)slot}};
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+static void deliver(const WireArrival* a, ArrivalHandler handler, void* ctx) {
+    Vehicle v;
+    memset(&v, 0, sizeof(v));
+    v.id = (int)a->id;
+    v.lane = a->lane;
+    v.intent = a->intent;
+    handler(v, ctx);
+}
+
+// Parse every complete frame at the front of the buffer, text or binary.
+// Returns arrivals delivered, or -1 if the stream is corrupt.
+static int parseFrames(NetServer* srv, NetConn* c, ArrivalHandler handler, void* ctx) {
+    int arrivals = 0;
+    int pos = 0;
+    while (pos < c->len) {
+        unsigned char* start = (unsigned char*)c->buf + pos;
+        int avail = c->len - pos;
+        if (start[0] == WIRE_MAGIC) {
+            WireArrival batch[WIRE_MAX_BATCH];
+            int consumed;
+            int n = wireDecodeFrame(start, avail, batch, &consumed);
+            if (n < 0) return -1;
+            if (consumed == 0) break; // rest of the frame not here yet
+            for (int i = 0; i < n; i++) {
+                if (batch[i].lane >= srv->num_lanes || batch[i].intent > INTENT_RIGHT) {
+                    srv->rejected++;
+                    continue;
+                }
+                deliver(&batch[i], handler, ctx);
+                arrivals++;
+            }
+            pos += consumed;
+        } else {
+            char* nl = memchr(start, '\n', avail);
+            if (nl == NULL) break;
+            *nl = '\0';
+            WireArrival a;
+            if (strncmp((char*)start, "MONITOR", 7) == 0) {
+                c->is_monitor = 1;
+            } else if (wireParseText((char*)start, srv->num_lanes, &a)) {
+                deliver(&a, handler, ctx);
+                arrivals++;
+            } else {
+                srv->rejected++;
+            }
+            pos = (int)(nl - c->buf) + 1;
+        }
+    }
+    c->len -= pos;
+    memmove(c->buf, c->buf + pos, c->len);
+    if (c->len == NET_CONN_BUFFER) return -1; // an unterminated line filled the buffer
+    return arrivals;
+}
+
+// Read everything available on a connection and deliver complete frames.
+// Returns the number of arrivals, or -1 if the peer has gone away.
+static int readConn(NetServer* srv, NetConn* c, ArrivalHandler handler, void* ctx) {
+    int arrivals = 0;
+    for (;;) {
+        ssize_t n = recv(c->fd, c->buf + c->len, NET_CONN_BUFFER - c->len, 0);
+        if (n == 0) return -1;
+        if (n < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? arrivals : -1;
+        c->len += (int)n;
+        int got = parseFrames(srv, c, handler, ctx);
+        if (got < 0) return -1;
+        arrivals += got;
+    }
+}
+
+// Block up to timeout_ms for socket activity. Returns 1 if something is ready.
+int netServerWait(NetServer* srv, int timeout_ms) {
+    struct epoll_event ev;
+    // Level-triggered, so peeking at one event leaves it pending for netServerPoll
+    return epoll_wait(srv->epoll_fd, &ev, 1, timeout_ms) > 0;
+}
+
+// Handle every ready socket without blocking; returns arrivals delivered
+int netServerPoll(NetServer* srv, ArrivalHandler handler, void* ctx) {
+    struct epoll_event events[NET_MAX_EVENTS];
+    int arrivals = 0;
+    int n;
+    do {
+        n = epoll_wait(srv->epoll_fd, events, NET_MAX_EVENTS, 0);
+        for (int i = 0; i < n; i++) {
+            unsigned int slot = events[i].data.u32;
+            if (slot == NET_LISTEN_TAG) {
+                acceptClients(srv);
+                continue;
+            }
+            if (slot == NET_WAKE_TAG) {
+                eventfd_t count;
+                eventfd_read(srv->wake_fd, &count);
+                continue;
+            }
+            NetConn* c = srv->conns[slot];
+            int got = readConn(srv, c, handler, ctx);
+            if (got > 0) arrivals += got;
+            if (got < 0 || (events[i].events & (EPOLLHUP | EPOLLERR))) closeConn(srv, slot);
+        }
+    } while (n == NET_MAX_EVENTS);
+    return arrivals;
+}
+
+// Send text to every monitor; a monitor that cannot keep up is skipped
+void netServerBroadcast(NetServer* srv, const char* text, int len) {
+    for (int i = 0; i < srv->conn_capacity; i++) {
+        NetConn* c = srv->conns[i];
+        if (c && c->is_monitor) send(c->fd, text, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+    }
+}
+
+// Make a blocked netServerWait return; safe to call from any thread
+void netServerWake(NetServer* srv) {
+    eventfd_write(srv->wake_fd, 1);
+}
+
+void closeNetServer(NetServer* srv) {
+    for (int i = 0; i < srv->conn_capacity; i++) {
+        if (srv->conns[i]) closeConn(srv, (unsigned int)i);
+    }
+    free(srv->conns);
+    close(srv->wake_fd);
+    close(srv->epoll_fd);
+    close(srv->listen_fd);
+}
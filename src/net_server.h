@@ -0,0 +1,47 @@
+#ifndef NET_SERVER_H
+#define NET_SERVER_H
+
+#include "queue.h"
+
+// Non-blocking, epoll-driven TCP server for generators and monitors.
+// Any number of clients may connect. Generators stream arrivals as text
+// lines or binary frames (see wire.h); each connection keeps its own
+// receive buffer, so a frame split across reads is parsed once it is
+// complete. A client that sends "MONITOR" receives the periodic status
+// text instead.
+//
+// The server itself is single-threaded: only the thread that polls it may
+// call netServerPoll/netServerBroadcast. Other threads use netServerWake to
+// interrupt a blocked netServerWait.
+
+#define NET_CONN_BUFFER 4096
+
+typedef void (*ArrivalHandler)(Vehicle v, void* ctx);
+
+typedef struct {
+    int fd;
+    int is_monitor;
+    int len;                    // bytes buffered in buf
+    char buf[NET_CONN_BUFFER];
+} NetConn;
+
+typedef struct {
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd;                // eventfd for netServerWake
+    NetConn** conns;            // slot table, NULL for free slots
+    int conn_capacity;
+    int clients;                // connected clients
+    int num_lanes;              // lane letters accepted: 'A' .. 'A'+num_lanes-1
+    long rejected;              // arrivals dropped for a bad lane, intent or text line
+} NetServer;
+
+// Function prototypes
+int openNetServer(NetServer* srv, int port, int num_lanes);
+int netServerWait(NetServer* srv, int timeout_ms);
+int netServerPoll(NetServer* srv, ArrivalHandler handler, void* ctx);
+void netServerBroadcast(NetServer* srv, const char* text, int len);
+void netServerWake(NetServer* srv);
+void closeNetServer(NetServer* srv);
+
+#endif // NET_SERVER_H
@@ -1,9 +1,29 @@
 #include "queue.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
-// Queue implementation using linked list for FIFO operations
-// Time: O(1) enqueue/dequeue, Space: O(n) for n vehicles
+// Queue implementation using a growable power-of-two ring buffer
+// Time: O(1) enqueue/dequeue (amortized on growth), Space: O(n) for n vehicles
+// Vehicles live in one contiguous block, so there is no per-vehicle malloc/free.
+
+// Double the capacity, keeping the queued vehicles in FIFO order
+static void growQueue(Queue* q) {
+    int old_capacity = q->capacity;
+    Vehicle* buffer = (Vehicle*)realloc(q->buffer, sizeof(Vehicle) * old_capacity * 2);
+    if (buffer == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    // The wrapped part [0, head) now belongs after the old end
+    if (q->head + q->size > old_capacity) {
+        int wrapped = q->head + q->size - old_capacity;
+        memcpy(buffer + old_capacity, buffer, sizeof(Vehicle) * wrapped);
+    }
+    q->buffer = buffer;
+    q->capacity = old_capacity * 2;
+    q->allocations++;
+}
 
 // Create a new queue
 Queue* createQueue() {
@@ -12,27 +32,29 @@ Queue* createQueue() {
         fprintf(stderr, "Memory allocation failed\n");
         exit(1);
     }
-    q->front = q->rear = NULL;
+    q->buffer = (Vehicle*)malloc(sizeof(Vehicle) * QUEUE_INITIAL_CAPACITY);
+    if (q->buffer == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    q->capacity = QUEUE_INITIAL_CAPACITY;
+    q->head = 0;
     q->size = 0;
+    q->high_water = 0;
+    q->allocations = 1;
+    q->enqueued = 0;
     return q;
 }
 
 // Enqueue a vehicle
 void enqueue(Queue* q, Vehicle v) {
-    Node* newNode = (Node*)malloc(sizeof(Node));
-    if (newNode == NULL) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
-    }
-    newNode->vehicle = v;
-    newNode->next = NULL;
-    if (q->rear == NULL) {
-        q->front = q->rear = newNode;
-    } else {
-        q->rear->next = newNode;
-        q->rear = newNode;
+    if (q->size == q->capacity) {
+        growQueue(q);
     }
+    q->buffer[(q->head + q->size) & (q->capacity - 1)] = v;
     q->size++;
+    q->enqueued++;
+    if (q->size > q->high_water) q->high_water = q->size;
 }
 
 // Dequeue a vehicle
@@ -41,20 +63,44 @@ Vehicle dequeue(Queue* q) {
         fprintf(stderr, "Queue is empty\n");
         exit(1);
     }
-    Node* temp = q->front;
-    Vehicle v = temp->vehicle;
-    q->front = q->front->next;
-    if (q->front == NULL) {
-        q->rear = NULL;
-    }
-    free(temp);
+    Vehicle v = q->buffer[q->head];
+    q->head = (q->head + 1) & (q->capacity - 1);
     q->size--;
     return v;
 }
 
+// Enqueue count vehicles in FIFO order with at most two block copies
+void enqueueBatch(Queue* q, const Vehicle* vs, int count) {
+    if (count <= 0) return;
+    while (q->size + count > q->capacity) {
+        growQueue(q);
+    }
+    int tail = (q->head + q->size) & (q->capacity - 1);
+    int first = q->capacity - tail;
+    if (first > count) first = count;
+    memcpy(q->buffer + tail, vs, sizeof(Vehicle) * first);
+    memcpy(q->buffer, vs + first, sizeof(Vehicle) * (count - first));
+    q->size += count;
+    q->enqueued += count;
+    if (q->size > q->high_water) q->high_water = q->size;
+}
+
+// Dequeue up to max vehicles into out; returns how many were copied
+int dequeueBatch(Queue* q, Vehicle* out, int max) {
+    int count = max < q->size ? max : q->size;
+    if (count <= 0) return 0;
+    int first = q->capacity - q->head;
+    if (first > count) first = count;
+    memcpy(out, q->buffer + q->head, sizeof(Vehicle) * first);
+    memcpy(out + first, q->buffer, sizeof(Vehicle) * (count - first));
+    q->head = (q->head + count) & (q->capacity - 1);
+    q->size -= count;
+    return count;
+}
+
 // Check if queue is empty
 bool isEmpty(Queue* q) {
-    return q->front == NULL;
+    return q->size == 0;
 }
 
 // Get size of queue
@@ -62,10 +108,21 @@ int getSize(Queue* q) {
     return q->size;
 }
 
+// Report storage statistics. Slots are recycled once the queue has drained
+// below its high-water mark, so only enqueues that raise the mark need fresh
+// storage; everything else reuses memory that is already allocated.
+QueueStats getQueueStats(Queue* q) {
+    QueueStats s;
+    s.high_water = q->high_water;
+    s.capacity = q->capacity;
+    s.allocations = q->allocations;
+    s.enqueued = q->enqueued;
+    s.reuse_ratio = q->enqueued > 0 ? (double)(q->enqueued - q->high_water) / q->enqueued : 0.0;
+    return s;
+}
+
 // Free the queue
 void freeQueue(Queue* q) {
-    while (!isEmpty(q)) {
-        dequeue(q);
-    }
+    free(q->buffer);
     free(q);
 }
@@ -3,25 +3,56 @@
 
 #include <stdbool.h>
 
-// Define Vehicle structure
+// Direction a vehicle is travelling when it reaches the junction
+typedef enum {
+    DIR_NORTH,
+    DIR_EAST,
+    DIR_SOUTH,
+    DIR_WEST
+} Direction;
+
+// What the vehicle does at the junction
+typedef enum {
+    INTENT_STRAIGHT,
+    INTENT_LEFT,
+    INTENT_RIGHT
+} TurnIntent;
+
+// Define Vehicle structure (16 bytes, so four records share a cache line)
+// Times are milliseconds of simulation time since the simulator started.
 typedef struct {
     int id;
-    // Add more fields if needed, e.g., arrival_time, etc.
+    unsigned char lane;         // lane index, 0 = A
+    unsigned char direction;    // Direction
+    unsigned char intent;       // TurnIntent
+    unsigned char reserved;
+    unsigned int arrival_ms;    // when the vehicle joined the lane queue
+    unsigned int departure_ms;  // when it passed the light (0 while queued)
 } Vehicle;
 
-// Node for linked list
-typedef struct Node {
-    Vehicle vehicle;
-    struct Node* next;
-} Node;
+// Initial number of slots in a new queue (must be a power of two)
+#define QUEUE_INITIAL_CAPACITY 16
 
-// Queue structure
+// Queue structure: growable ring buffer of vehicles
 typedef struct {
-    Node* front;
-    Node* rear;
-    int size;
+    Vehicle* buffer;   // contiguous storage, capacity slots
+    int capacity;      // always a power of two
+    int head;          // index of the front vehicle
+    int size;          // number of vehicles currently queued
+    int high_water;    // largest size reached so far
+    int allocations;   // buffer allocations (initial + each growth)
+    long enqueued;     // vehicles ever enqueued
 } Queue;
 
+// Storage statistics for a queue
+typedef struct {
+    int high_water;      // peak number of queued vehicles
+    int capacity;        // slots currently allocated
+    int allocations;     // times the buffer was (re)allocated
+    long enqueued;       // vehicles ever enqueued
+    double reuse_ratio;  // share of enqueues that recycled an existing slot
+} QueueStats;
+
 // Function prototypes
 Queue* createQueue();
 void enqueue(Queue* q, Vehicle v);
@@ -29,5 +60,8 @@ Vehicle dequeue(Queue* q);
 bool isEmpty(Queue* q);
 int getSize(Queue* q);
 void freeQueue(Queue* q);
+void enqueueBatch(Queue* q, const Vehicle* vs, int count);
+int dequeueBatch(Queue* q, Vehicle* out, int max);
+QueueStats getQueueStats(Queue* q);
 
 #endif // QUEUE_H
@@ -1,16 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#ifndef _WIN32
-#include <unistd.h>
-#endif
-
-#ifdef _WIN32
-#include <windows.h>
-#define sleep(x) Sleep(x * 1000)
-#endif
+#include "lane_ingest.h"
 
 #define NUM_LANES 4
+#define RECEIVER_WAIT_MS 1000    // recount anyway when no change is reported
 
 const char* lane_files[NUM_LANES] = {
     "data/lanea.txt",
@@ -20,21 +14,30 @@ const char* lane_files[NUM_LANES] = {
 };
 
 int main() {
+    // Lines in each lane file: vehicles a generator wrote while running
+    // without the simulator, not yet taken by `simulator --files`. A
+    // generator connected to the simulator leaves the files alone.
     printf("Receiver started: monitoring lane files...\n");
+    LaneIngest lanes;
+    initLaneIngest(&lanes, lane_files, NUM_LANES);
+    long shown[NUM_LANES];
+    for (int i = 0; i < NUM_LANES; i++) {
+        shown[i] = countLane(&lanes, i);
+        printf("Lane %c: %ld lines in lane file\n", 'A' + i, shown[i]);
+    }
+    fflush(stdout);
+
     while (1) {
+        // Wakes as soon as a lane file changes; only appended bytes are counted
+        ingestWait(&lanes, RECEIVER_WAIT_MS);
+        if (countChanged(&lanes) == 0) continue;
         for (int i = 0; i < NUM_LANES; i++) {
-            FILE* fp = fopen(lane_files[i], "r");
-            if (fp) {
-                char line[256];
-                int count = 0;
-                while (fgets(line, sizeof(line), fp)) {
-                    count++;
-                }
-                fclose(fp);
-                printf("Lane %c: %d vehicles waiting\n", 'A' + i, count);
-            }
+            if (lanes.lanes[i].lines == shown[i]) continue;
+            shown[i] = lanes.lanes[i].lines;
+            printf("Lane %c: %ld lines in lane file\n", 'A' + i, shown[i]);
         }
-        sleep(10); // Check every 10 seconds
+        fflush(stdout);
     }
+    closeLaneIngest(&lanes);
     return 0;
 }
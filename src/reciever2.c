@@ -1,16 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#ifndef _WIN32
-#include <unistd.h>
-#endif
-
-#ifdef _WIN32
-#include <windows.h>
-#define sleep(x) Sleep(x * 1000)
-#endif
+#include <time.h>
+#include "lane_ingest.h"
+#include "sim_log.h"
 
 #define NUM_LANES 4
+#define RECEIVER_WAIT_MS 1000    // recount anyway when no change is reported
 
 const char* lane_files[NUM_LANES] = {
     "data/lanea.txt",
@@ -19,34 +15,52 @@ const char* lane_files[NUM_LANES] = {
     "data/laned.txt"
 };
 
+// Milliseconds since the receiver started
+unsigned int elapsed_ms() {
+    static struct timespec start;
+    struct timespec now;
+    if (start.tv_sec == 0 && start.tv_nsec == 0) clock_gettime(CLOCK_MONOTONIC, &start);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned int)((now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000);
+}
+
 int main() {
-    FILE* log_fp = fopen("simulation_log.txt", "w");
-    if (log_fp == NULL) {
+    // Appends to the same event log as the simulator, tagged "reciever2"
+    SimLog log;
+    int log_err = openSimLog(&log, LOG_JSON_PATH, "reciever2", LOG_FORMAT_JSON, LOG_INFO);
+    if (log_err == 2) {
+        fprintf(stderr, "%s holds a log in another format, not appending JSON records to it\n", LOG_JSON_PATH);
+        return 1;
+    } else if (log_err) {
         perror("Log file open failed");
         return 1;
     }
 
     printf("Receiver 2: Logging mode started.\n");
-    fprintf(log_fp, "Simulation Log Started\n");
+    SIM_LOG(&log, LOG_INFO, LOG_EV_START, 0, 0, elapsed_ms(), 0, 0);
+
+    LaneIngest lanes;
+    initLaneIngest(&lanes, lane_files, NUM_LANES);
+    long logged[NUM_LANES];
+    for (int i = 0; i < NUM_LANES; i++) logged[i] = -1;
+    countChanged(&lanes);
 
     while (1) {
+        // Log every lane file whose line count moved; the first pass logs them all
         for (int i = 0; i < NUM_LANES; i++) {
-            FILE* fp = fopen(lane_files[i], "r");
-            if (fp) {
-                char line[256];
-                int count = 0;
-                while (fgets(line, sizeof(line), fp)) {
-                    count++;
-                }
-                fclose(fp);
-                printf("Lane %c: %d vehicles\n", 'A' + i, count);
-                fprintf(log_fp, "Lane %c: %d vehicles\n", 'A' + i, count);
-                fflush(log_fp);
-            }
+            if (lanes.lanes[i].fd < 0 || lanes.lanes[i].lines == logged[i]) continue;
+            logged[i] = lanes.lanes[i].lines;
+            printf("Lane %c: %ld lines in lane file\n", 'A' + i, logged[i]);
+            SIM_LOG(&log, LOG_INFO, LOG_EV_LANE_FILE, i, 0, elapsed_ms(), 0, (unsigned int)logged[i]);
         }
-        sleep(10);
+        fflush(stdout);
+        // Wakes as soon as a lane file changes; only appended bytes are counted
+        do {
+            ingestWait(&lanes, RECEIVER_WAIT_MS);
+        } while (countChanged(&lanes) == 0);
     }
 
-    fclose(log_fp);
+    closeLaneIngest(&lanes);
+    closeSimLog(&log);
     return 0;
 }
@@ -0,0 +1,39 @@
+#include "report_queue.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+// Report wrapper around SpscRing (spsc_ring.h has the protocol)
+
+// Create a queue holding at least capacity reports
+ReportQueue* createReportQueue(int capacity) {
+    ReportQueue* q = (ReportQueue*)aligned_alloc(CACHE_LINE_SIZE, sizeof(ReportQueue));
+    if (q == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    initSpscRing(&q->ring, capacity, sizeof(Report));
+    return q;
+}
+
+// Producer only: append a report, false if the ring is full
+bool reportEnqueue(ReportQueue* q, const Report* r) {
+    Report* slot = (Report*)spscRingClaim(&q->ring);
+    if (slot == NULL) return false;
+    *slot = *r;
+    spscRingPublish(&q->ring);
+    return true;
+}
+
+// Consumer only: take the oldest report, false if the ring is empty
+bool reportDequeue(ReportQueue* q, Report* out) {
+    if (spscRingReadable(&q->ring, 1) == 0) return false;
+    *out = *(Report*)spscRingSlot(&q->ring, spscRingHead(&q->ring));
+    spscRingRelease(&q->ring, 1);
+    return true;
+}
+
+// Free the queue; neither side may be using it
+void freeReportQueue(ReportQueue* q) {
+    freeSpscRing(&q->ring);
+    free(q);
+}
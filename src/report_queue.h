@@ -0,0 +1,56 @@
+#ifndef REPORT_QUEUE_H
+#define REPORT_QUEUE_H
+
+#include <stdbool.h>
+#include "queue.h"
+#include "spsc_ring.h"
+
+#define REPORT_MAX_LANES 4
+
+// Something the scheduler wants printed, logged or sent to monitors
+typedef enum {
+    REPORT_LIGHT,         // light changed; value = 1 for GREEN, 0 for RED
+    REPORT_ARRIVAL,       // a generator delivered vehicle
+    REPORT_PASSED,        // vehicle passed the light; value = 1 from the priority lane
+    REPORT_PRIORITY_ON,   // lane became the priority lane; value = its size
+    REPORT_PRIORITY_OFF,  // lane returned to normal scheduling; value = the leave threshold
+    REPORT_ESTIMATE,      // value = vehicles to serve in this slot
+    REPORT_STATUS         // periodic snapshot; value = light, lanes[] filled in
+} ReportType;
+
+// Per-lane numbers carried by REPORT_STATUS
+typedef struct {
+    int size;
+    int high_water;
+    int capacity;
+    double reuse_ratio;
+    unsigned long served;
+    unsigned int p50_ms;
+    unsigned int p99_ms;
+    unsigned int max_ms;
+} LaneSnapshot;
+
+typedef struct {
+    ReportType type;
+    unsigned int time_ms;        // simulation time it happened
+    int lane;
+    int value;
+    Vehicle vehicle;
+    unsigned int light_left_ms;  // REPORT_STATUS: time until the next light change
+    LaneSnapshot lanes[REPORT_MAX_LANES];
+} Report;
+
+// Lock-free single-producer/single-consumer ring of reports (an SpscRing):
+// the scheduler posts without blocking, the reporter thread drains.
+// Capacity is fixed; enqueue reports false when the ring is full.
+typedef struct {
+    SpscRing ring;              // slots hold Reports
+} ReportQueue;
+
+// Function prototypes
+ReportQueue* createReportQueue(int capacity);
+bool reportEnqueue(ReportQueue* q, const Report* r);
+bool reportDequeue(ReportQueue* q, Report* out);
+void freeReportQueue(ReportQueue* q);
+
+#endif // REPORT_QUEUE_H
@@ -0,0 +1,141 @@
+#include "scheduler.h"
+#include <string.h>
+
+static const char* scheduler_names[SCHED_KIND_COUNT] = {
+    "roundrobin",
+    "proportional",
+    "drr",
+    "maxpressure"
+};
+
+// |V| = (1/n) * sum Li, at least one vehicle while any lane is waiting
+static int fairShare(const int lengths[NUM_LANES]) {
+    int total = 0;
+    for (int l = 0; l < NUM_LANES; l++) total += lengths[l];
+    int share = total / NUM_LANES;
+    return share < 1 && total > 0 ? 1 : share;
+}
+
+static int planRoundRobin(LaneScheduler* s, const int lengths[NUM_LANES], int capacity, int take[NUM_LANES]) {
+    (void)s;
+    int target = fairShare(lengths);
+    int served = 0;
+    for (int l = 0; l < NUM_LANES && served < target && served < capacity; l++) {
+        if (lengths[l] > 0) {
+            take[l] = 1;
+            served++;
+        }
+    }
+    return target;
+}
+
+// Hand out total/n slots one at a time to the lane with the highest
+// weighted length per slot already given (D'Hondt apportionment), so the
+// split is proportional and never exceeds what a lane holds
+static int planProportional(LaneScheduler* s, const int lengths[NUM_LANES], int capacity, int take[NUM_LANES]) {
+    int target = fairShare(lengths);
+    if (target > capacity) target = capacity;
+    for (int n = 0; n < target; n++) {
+        int best = -1;
+        long best_num = 0, best_den = 1;
+        for (int l = 0; l < NUM_LANES; l++) {
+            if (take[l] >= lengths[l]) continue;
+            long num = (long)s->weights[l] * lengths[l];
+            long den = take[l] + 1;
+            if (best < 0 || num * best_den > best_num * den) {
+                best = l;
+                best_num = num;
+                best_den = den;
+            }
+        }
+        take[best]++;
+    }
+    return target;
+}
+
+// Each backlogged lane earns its weight in credit per round and sends one
+// vehicle per credit; a slot that fills up mid-round resumes there next time
+static int planDrr(LaneScheduler* s, const int lengths[NUM_LANES], int capacity, int take[NUM_LANES]) {
+    int waiting = 0;
+    for (int l = 0; l < NUM_LANES; l++) waiting += lengths[l];
+    int served = 0;
+    int fruitless = 0; // visits in a row that sent nothing (zero weights)
+    while (served < capacity && served < waiting && fruitless <= NUM_LANES) {
+        int l = s->next_lane;
+        int left = lengths[l] - take[l];
+        if (left > 0) {
+            if (!s->credited) {
+                s->deficit[l] += s->weights[l];
+                s->credited = 1;
+            }
+            int n = s->deficit[l];
+            if (n > left) n = left;
+            if (n > capacity - served) n = capacity - served;
+            take[l] += n;
+            s->deficit[l] -= n;
+            served += n;
+            left -= n;
+            fruitless = n > 0 ? 0 : fruitless + 1;
+            if (s->deficit[l] > 0 && left > 0) break; // slot full, keep our turn
+        } else {
+            fruitless++;
+        }
+        if (left == 0) s->deficit[l] = 0; // idle lanes do not bank credit
+        s->next_lane = (l + 1) % NUM_LANES;
+        s->credited = 0;
+    }
+    return served;
+}
+
+// A lone junction cannot see downstream queues, so pressure is the
+// weighted length of the queue itself
+static int planMaxPressure(LaneScheduler* s, const int lengths[NUM_LANES], int capacity, int take[NUM_LANES]) {
+    int served = 0;
+    while (served < capacity) {
+        int best = -1;
+        long best_pressure = 0;
+        for (int l = 0; l < NUM_LANES; l++) {
+            long pressure = (long)s->weights[l] * (lengths[l] - take[l]);
+            if (pressure > best_pressure) {
+                best = l;
+                best_pressure = pressure;
+            }
+        }
+        if (best < 0) break;
+        take[best]++;
+        served++;
+    }
+    return served;
+}
+
+static const PlanFn plan_functions[SCHED_KIND_COUNT] = {
+    planRoundRobin,
+    planProportional,
+    planDrr,
+    planMaxPressure
+};
+
+void initLaneScheduler(LaneScheduler* s, SchedulerKind kind) {
+    memset(s, 0, sizeof(*s));
+    s->kind = kind;
+    s->plan = plan_functions[kind];
+    for (int l = 0; l < NUM_LANES; l++) s->weights[l] = 1;
+}
+
+// Policy for a command-line name, or -1 if there is none
+int schedulerKindFromName(const char* name) {
+    for (int k = 0; k < SCHED_KIND_COUNT; k++) {
+        if (strcmp(name, scheduler_names[k]) == 0) return k;
+    }
+    return -1;
+}
+
+const char* schedulerName(SchedulerKind kind) {
+    return scheduler_names[kind];
+}
+
+// Lane A (AL2) becomes priority above 10 vehicles and stays until below 5
+PriorityRule defaultPriorityRule() {
+    PriorityRule rule = {0, 10, 5, NUM_LANES};
+    return rule;
+}
@@ -0,0 +1,47 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#define NUM_LANES 4
+
+// Lane scheduling policies for the normal (no priority lane) case
+typedef enum {
+    SCHED_ROUND_ROBIN,   // original stub: aims for total/n, at most one per lane
+    SCHED_PROPORTIONAL,  // serves total/n, split in proportion to weighted lane length
+    SCHED_DRR,           // deficit round-robin, weights are per-round quanta
+    SCHED_MAX_PRESSURE,  // always serves the longest weighted queue next
+    SCHED_KIND_COUNT
+} SchedulerKind;
+
+typedef struct LaneScheduler LaneScheduler;
+
+// Decide how many vehicles each lane sends in one dispatch slot: fills take[]
+// (take[l] <= lengths[l], sum <= capacity) and returns the number the policy
+// aimed to serve. Any function with this shape can be plugged in.
+typedef int (*PlanFn)(LaneScheduler* s, const int lengths[NUM_LANES], int capacity, int take[NUM_LANES]);
+
+struct LaneScheduler {
+    SchedulerKind kind;
+    PlanFn plan;
+    int weights[NUM_LANES];   // relative share of each lane (default 1)
+    int deficit[NUM_LANES];   // DRR: service credit carried between slots
+    int next_lane;            // DRR: lane whose turn it is
+    int credited;             // DRR: next_lane already got its quantum this round
+};
+
+// Priority lane rule, checked before the policy runs: once `lane` holds more
+// than enter_above vehicles it is served alone, per_slot vehicles per slot,
+// until it drops below leave_below.
+typedef struct {
+    int lane;            // -1 disables the rule
+    int enter_above;
+    int leave_below;
+    int per_slot;
+} PriorityRule;
+
+// Function prototypes
+void initLaneScheduler(LaneScheduler* s, SchedulerKind kind);
+int schedulerKindFromName(const char* name);
+const char* schedulerName(SchedulerKind kind);
+PriorityRule defaultPriorityRule();
+
+#endif // SCHEDULER_H
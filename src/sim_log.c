@@ -0,0 +1,217 @@
+#include "sim_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static const char* level_names[] = {"off", "error", "warn", "info", "debug"};
+static const char* event_names[LOG_EV_COUNT] = {
+    "start", "end", "light", "arrival", "pass", "priority_on", "priority_off", "queue", "dropped", "lane_file"
+};
+
+int logLevelFromName(const char* name) {
+    for (int i = 0; i <= LOG_DEBUG; i++) {
+        if (strcmp(name, level_names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+int logFormatFromName(const char* name) {
+    if (strcmp(name, "json") == 0) return LOG_FORMAT_JSON;
+    if (strcmp(name, "binary") == 0) return LOG_FORMAT_BINARY;
+    return -1;
+}
+
+static void put32(unsigned char* p, unsigned int v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static unsigned int get32(const unsigned char* p) {
+    return (unsigned int)p[0] | (unsigned int)p[1] << 8 | (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24;
+}
+
+void encodeLogRecord(const LogRecord* r, unsigned char* out) {
+    out[0] = r->level;
+    out[1] = r->event;
+    out[2] = r->lane;
+    out[3] = r->flag;
+    put32(out + 4, r->time_ms);
+    put32(out + 8, r->id);
+    put32(out + 12, r->value);
+}
+
+void decodeLogRecord(const unsigned char* in, LogRecord* r) {
+    r->level = in[0];
+    r->event = in[1];
+    r->lane = in[2];
+    r->flag = in[3];
+    r->time_ms = get32(in + 4);
+    r->id = get32(in + 8);
+    r->value = get32(in + 12);
+}
+
+// One JSON line (with its newline) for a record. Returns its length.
+int formatLogJson(const LogRecord* r, const char* source, char* out, int size) {
+    const char* level = r->level <= LOG_DEBUG ? level_names[r->level] : "?";
+    const char* event = r->event < LOG_EV_COUNT ? event_names[r->event] : "?";
+    int len = snprintf(out, size, "{\"t_ms\":%u,\"src\":\"%s\",\"level\":\"%s\",\"event\":\"%s\"", r->time_ms,
+                       source, level, event);
+    char lane = (char)('A' + r->lane);
+    switch (r->event) {
+        case LOG_EV_END:
+            len += snprintf(out + len, size - len, ",\"served\":%u", r->value);
+            break;
+        case LOG_EV_LIGHT:
+            len += snprintf(out + len, size - len, ",\"light\":\"%s\",\"next_change_ms\":%u",
+                            r->flag == 1 ? "green" : r->flag == 2 ? "resting" : "red", r->value);
+            break;
+        case LOG_EV_ARRIVAL:
+            len += snprintf(out + len, size - len, ",\"lane\":\"%c\",\"id\":%u", lane, r->id);
+            break;
+        case LOG_EV_PASS:
+            len += snprintf(out + len, size - len, ",\"lane\":\"%c\",\"id\":%u,\"priority\":%s,\"wait_ms\":%u", lane,
+                            r->id, r->flag ? "true" : "false", r->value);
+            break;
+        case LOG_EV_PRIORITY_ON:
+        case LOG_EV_QUEUE:
+            len += snprintf(out + len, size - len, ",\"lane\":\"%c\",\"size\":%u", lane, r->value);
+            break;
+        case LOG_EV_PRIORITY_OFF:
+            len += snprintf(out + len, size - len, ",\"lane\":\"%c\"", lane);
+            break;
+        case LOG_EV_DROPPED:
+            len += snprintf(out + len, size - len, ",\"count\":%u", r->value);
+            break;
+        case LOG_EV_LANE_FILE:
+            len += snprintf(out + len, size - len, ",\"lane\":\"%c\",\"lines\":%u", lane, r->value);
+            break;
+    }
+    len += snprintf(out + len, size - len, "}\n");
+    return len < size ? len : size - 1;
+}
+
+static void writeAll(int fd, const char* buf, int len) {
+    int done = 0;
+    while (done < len) {
+        int n = (int)write(fd, buf + done, len - done);
+        if (n <= 0) return;
+        done += n;
+    }
+}
+
+// Writer thread only: take the oldest record, 0 if the ring is empty
+static int logDequeue(SimLog* lg, LogRecord* out) {
+    if (spscRingReadable(&lg->ring, 1) == 0) return 0;
+    *out = *(LogRecord*)spscRingSlot(&lg->ring, spscRingHead(&lg->ring));
+    spscRingRelease(&lg->ring, 1);
+    return 1;
+}
+
+static int appendRecord(SimLog* lg, const LogRecord* r, char* out) {
+    if (lg->format == LOG_FORMAT_BINARY) {
+        encodeLogRecord(r, (unsigned char*)out);
+        return LOG_RECORD_SIZE;
+    }
+    return formatLogJson(r, lg->source, out, LOG_LINE_MAX);
+}
+
+// Drain the ring into one buffer per pass and append it with write()
+static void* logWriterMain(void* arg) {
+    SimLog* lg = (SimLog*)arg;
+    char* buf = (char*)malloc(LOG_WRITE_BUFFER);
+    if (buf == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    for (;;) {
+        // Everything posted before the stop flag is still written
+        int stopping = !atomic_load(&lg->running);
+        int len = 0;
+        LogRecord r;
+        while (logDequeue(lg, &r)) {
+            if (len > LOG_WRITE_BUFFER - LOG_LINE_MAX) {
+                writeAll(lg->fd, buf, len);
+                len = 0;
+            }
+            len += appendRecord(lg, &r, buf + len);
+        }
+        if (len > 0) writeAll(lg->fd, buf, len);
+        if (stopping) break;
+        usleep(LOG_IDLE_US);
+    }
+    free(buf);
+    return NULL;
+}
+
+// Open (append to) the log and start its writer thread. A level of LOG_OFF
+// opens nothing. Returns 1 if the file cannot be opened (errno set), 2 if
+// it already holds a log in the other format (or a binary log of another
+// version).
+int openSimLog(SimLog* lg, const char* path, const char* source, LogFormat format, LogLevel level) {
+    memset(lg, 0, sizeof(*lg));
+    lg->fd = -1;
+    if (level == LOG_OFF) return 0;
+    int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return 1;
+    unsigned char h[LOG_HEADER_SIZE] = {0};
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        int n = (int)pread(fd, h, sizeof(h), 0);
+        int binary = n >= 4 && memcmp(h, LOG_MAGIC, 4) == 0;
+        if (format == LOG_FORMAT_BINARY ? !binary || n < LOG_HEADER_SIZE || h[4] != LOG_VERSION : binary) {
+            close(fd);
+            return 2;
+        }
+    } else if (format == LOG_FORMAT_BINARY) {
+        memcpy(h, LOG_MAGIC, 4);
+        h[4] = LOG_VERSION;
+        writeAll(fd, (const char*)h, sizeof(h));
+    }
+    lg->fd = fd;
+    initSpscRing(&lg->ring, LOG_RING_SIZE, sizeof(LogRecord));
+    lg->format = format;
+    lg->source = source;
+    lg->level = level;
+    atomic_store(&lg->running, 1);
+    pthread_create(&lg->writer, NULL, logWriterMain, lg);
+    return 0;
+}
+
+// Producer only: queue a record without blocking; dropped if the ring is full
+void logPost(SimLog* lg, LogLevel level, LogEvent event, int lane, int flag, unsigned int time_ms,
+             unsigned int id, unsigned int value) {
+    LogRecord* r = (LogRecord*)spscRingClaim(&lg->ring);
+    if (r == NULL) {
+        lg->dropped++;
+        return;
+    }
+    r->level = (unsigned char)level;
+    r->event = (unsigned char)event;
+    r->lane = (unsigned char)lane;
+    r->flag = (unsigned char)flag;
+    r->time_ms = time_ms;
+    r->id = id;
+    r->value = value;
+    spscRingPublish(&lg->ring);
+}
+
+// Write out everything posted, stop the writer and close the file
+void closeSimLog(SimLog* lg) {
+    if (lg->fd < 0) return;
+    atomic_store(&lg->running, 0);
+    pthread_join(lg->writer, NULL);
+    if (lg->dropped > 0) {
+        LogRecord r = {LOG_WARN, LOG_EV_DROPPED, 0, 0, 0, 0, (unsigned int)lg->dropped};
+        char line[LOG_LINE_MAX];
+        writeAll(lg->fd, line, appendRecord(lg, &r, line));
+    }
+    close(lg->fd);
+    freeSpscRing(&lg->ring);
+    lg->fd = -1;
+    lg->level = LOG_OFF;
+}
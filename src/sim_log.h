@@ -0,0 +1,105 @@
+#ifndef SIM_LOG_H
+#define SIM_LOG_H
+
+#include <stdatomic.h>
+#include <pthread.h>
+#include "spsc_ring.h"
+
+// Asynchronous structured log (simulation_log.txt by default). A log site
+// fills a fixed 16-byte record and drops it into a lock-free SPSC ring;
+// a background thread formats the records (JSON lines or binary) and
+// appends them with large write() calls. Nothing on the producing side
+// formats text, blocks or makes a syscall; a full ring drops the record
+// and counts it. A site below the logger's level costs one compare, and
+// sites above LOG_MAX_LEVEL are compiled out.
+//
+// One thread posts per logger. The file is opened O_APPEND, so the
+// simulator and reciever2 can share it; each JSON line names its source.
+// Binary records carry no source, so a binary log gets its own file
+// (LOG_BINARY_PATH by default), and neither format is ever appended to a
+// file written in the other.
+
+typedef enum {
+    LOG_OFF,
+    LOG_ERROR,
+    LOG_WARN,
+    LOG_INFO,
+    LOG_DEBUG
+} LogLevel;
+
+#ifndef LOG_MAX_LEVEL
+#define LOG_MAX_LEVEL LOG_DEBUG
+#endif
+
+typedef enum {
+    LOG_FORMAT_JSON,     // one JSON object per line
+    LOG_FORMAT_BINARY    // "QLOG" header, then 16-byte records
+} LogFormat;
+
+typedef enum {
+    LOG_EV_START,        // logging began
+    LOG_EV_END,          // value = vehicles served
+    LOG_EV_LIGHT,        // flag = 1 GREEN, 0 RED, 2 resting RED; value = next change (ms)
+    LOG_EV_ARRIVAL,      // lane, id
+    LOG_EV_PASS,         // lane, id, flag = from the priority lane, value = wait (ms)
+    LOG_EV_PRIORITY_ON,  // lane, value = its size
+    LOG_EV_PRIORITY_OFF, // lane
+    LOG_EV_QUEUE,        // lane, value = vehicles waiting
+    LOG_EV_DROPPED,      // value = records or reports lost to a full ring
+    LOG_EV_LANE_FILE,    // lane, value = lines in its lane file (reciever2)
+    LOG_EV_COUNT
+} LogEvent;
+
+typedef struct {
+    unsigned char level;
+    unsigned char event;
+    unsigned char lane;
+    unsigned char flag;
+    unsigned int time_ms;
+    unsigned int id;
+    unsigned int value;
+} LogRecord;
+
+#define LOG_MAGIC "QLOG"
+#define LOG_VERSION 1
+#define LOG_HEADER_SIZE 8
+#define LOG_RECORD_SIZE 16
+#define LOG_RING_SIZE 16384
+#define LOG_WRITE_BUFFER (64 * 1024)
+#define LOG_IDLE_US 5000         // writer nap when the ring is empty
+#define LOG_LINE_MAX 160
+#define LOG_JSON_PATH "simulation_log.txt"
+#define LOG_BINARY_PATH "simulation_log.bin"
+
+typedef struct {
+    SpscRing ring;               // producer -> writer thread, slots hold LogRecords
+    LogLevel level;              // LOG_OFF until opened
+    long dropped;                // producer only
+    LogFormat format;
+    const char* source;
+    int fd;
+    atomic_int running;
+    pthread_t writer;
+} SimLog;
+
+static inline int logEnabled(const SimLog* lg, LogLevel level) {
+    return level <= LOG_MAX_LEVEL && level <= lg->level;
+}
+
+#define SIM_LOG(lg, lvl, ev, lane, flag, time_ms, id, value)                  \
+    do {                                                                     \
+        if (logEnabled((lg), (lvl))) logPost((lg), (lvl), (ev), (lane), (flag), (time_ms), (id), (value)); \
+    } while (0)
+
+// Function prototypes
+int openSimLog(SimLog* lg, const char* path, const char* source, LogFormat format, LogLevel level);
+void logPost(SimLog* lg, LogLevel level, LogEvent event, int lane, int flag, unsigned int time_ms,
+             unsigned int id, unsigned int value);
+void closeSimLog(SimLog* lg);
+int formatLogJson(const LogRecord* r, const char* source, char* out, int size);
+void encodeLogRecord(const LogRecord* r, unsigned char* out);
+void decodeLogRecord(const unsigned char* in, LogRecord* r);
+int logLevelFromName(const char* name);
+int logFormatFromName(const char* name);
+
+#endif // SIM_LOG_H
@@ -0,0 +1,111 @@
+#include "sim_trace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TRACE_WRITE_BUFFER (256 * 1024)   // records are flushed in large writes
+
+static void put32(unsigned char* p, unsigned int v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static unsigned int get32(const unsigned char* p) {
+    return (unsigned int)p[0] | (unsigned int)p[1] << 8 | (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24;
+}
+
+// Create (or replace) a trace file and write its header. Returns 1 on error.
+int openTraceWriter(TraceWriter* w, const char* path, const TraceSettings* s) {
+    w->records = 0;
+    w->fp = fopen(path, "wb");
+    if (w->fp == NULL) return 1;
+    setvbuf(w->fp, NULL, _IOFBF, TRACE_WRITE_BUFFER);
+
+    unsigned char h[TRACE_HEADER_SIZE];
+    memset(h, 0, sizeof(h));
+    memcpy(h, TRACE_MAGIC, 4);
+    h[4] = TRACE_VERSION;
+    h[5] = (unsigned char)s->scheduler;
+    h[6] = (unsigned char)s->adaptive;
+    h[7] = s->priority.lane < 0 ? 0xFF : (unsigned char)s->priority.lane;
+    put32(h + 8, (unsigned int)s->priority.enter_above);
+    put32(h + 12, (unsigned int)s->priority.leave_below);
+    put32(h + 16, (unsigned int)s->priority.per_slot);
+    fwrite(h, 1, sizeof(h), w->fp);
+    return 0;
+}
+
+void traceWrite(TraceWriter* w, const TraceRecord* r) {
+    unsigned char b[TRACE_RECORD_SIZE];
+    b[0] = r->type;
+    b[1] = r->lane;
+    b[2] = r->value;
+    b[3] = 0;
+    put32(b + 4, r->time_ms);
+    put32(b + 8, r->id);
+    put32(b + 12, r->aux);
+    fwrite(b, 1, sizeof(b), w->fp);
+    w->records++;
+}
+
+void closeTraceWriter(TraceWriter* w) {
+    if (w->fp) fclose(w->fp);
+    w->fp = NULL;
+}
+
+// Map a trace and check its header. Returns 1 if it cannot be used.
+int openTraceReader(TraceReader* r, const char* path) {
+    memset(r, 0, sizeof(*r));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 1;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < TRACE_HEADER_SIZE ||
+        (st.st_size - TRACE_HEADER_SIZE) % TRACE_RECORD_SIZE != 0) {
+        close(fd);
+        return 1;
+    }
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return 1;
+    r->base = (const unsigned char*)base;
+    r->size = (size_t)st.st_size;
+    // Replay reads the records front to back exactly once
+    madvise(base, r->size, MADV_SEQUENTIAL);
+
+    const unsigned char* h = r->base;
+    if (memcmp(h, TRACE_MAGIC, 4) != 0 || h[4] != TRACE_VERSION || h[5] >= SCHED_KIND_COUNT) {
+        closeTraceReader(r);
+        return 1;
+    }
+    r->settings.scheduler = (SchedulerKind)h[5];
+    r->settings.adaptive = h[6];
+    r->settings.priority.lane = h[7] == 0xFF ? -1 : h[7];
+    r->settings.priority.enter_above = (int)get32(h + 8);
+    r->settings.priority.leave_below = (int)get32(h + 12);
+    r->settings.priority.per_slot = (int)get32(h + 16);
+    r->count = (long)((r->size - TRACE_HEADER_SIZE) / TRACE_RECORD_SIZE);
+    return 0;
+}
+
+TraceRecord traceRecordAt(const TraceReader* r, long index) {
+    const unsigned char* b = r->base + TRACE_HEADER_SIZE + (size_t)index * TRACE_RECORD_SIZE;
+    TraceRecord rec;
+    rec.type = b[0];
+    rec.lane = b[1];
+    rec.value = b[2];
+    rec.time_ms = get32(b + 4);
+    rec.id = get32(b + 8);
+    rec.aux = get32(b + 12);
+    return rec;
+}
+
+void closeTraceReader(TraceReader* r) {
+    if (r->base) munmap((void*)r->base, r->size);
+    r->base = NULL;
+    r->count = 0;
+}
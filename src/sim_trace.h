@@ -0,0 +1,80 @@
+#ifndef SIM_TRACE_H
+#define SIM_TRACE_H
+
+#include <stdio.h>
+#include "scheduler.h"
+
+// Binary record of one simulator run: every arrival the scheduler enqueued
+// and every decision it made, in the order they happened. Replaying the
+// arrivals through the same settings must reproduce the decisions exactly.
+//
+// File layout (little-endian), append-only:
+//     32-byte header
+//         bytes 0-3   TRACE_MAGIC "QTRC"
+//         byte 4      TRACE_VERSION
+//         byte 5      scheduler (SchedulerKind)
+//         byte 6      1 = adaptive green timing
+//         byte 7      priority lane, 0xFF = none
+//         bytes 8-19  priority enter_above, leave_below, per_slot
+//         bytes 20-31 reserved, 0
+//     then TRACE_RECORD_SIZE-byte records
+//         byte 0      type (TraceType)
+//         byte 1      lane
+//         byte 2      value: intent, light state or from-priority flag
+//         byte 3      reserved, 0
+//         bytes 4-7   simulation time, ms
+//         bytes 8-11  vehicle id
+//         bytes 12-15 aux: see TraceType
+
+#define TRACE_MAGIC "QTRC"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 32
+#define TRACE_RECORD_SIZE 16
+
+typedef enum {
+    TRACE_ARRIVAL = 1,  // vehicle enqueued; aux = scheduler events handled before it
+    TRACE_PASS,         // vehicle passed the light; value = 1 from the priority lane
+    TRACE_LIGHT,        // light decision; value = LightState or TRACE_LIGHT_RESTING, aux = next change
+    TRACE_END           // run stopped; aux = scheduler events handled
+} TraceType;
+
+#define TRACE_LIGHT_RESTING 2
+
+typedef struct {
+    unsigned char type;
+    unsigned char lane;
+    unsigned char value;
+    unsigned int time_ms;
+    unsigned int id;
+    unsigned int aux;
+} TraceRecord;
+
+// Settings a replay needs to make the same decisions
+typedef struct {
+    SchedulerKind scheduler;
+    int adaptive;
+    PriorityRule priority;
+} TraceSettings;
+
+typedef struct {
+    FILE* fp;
+    long records;
+} TraceWriter;
+
+// A trace mapped read-only into memory
+typedef struct {
+    const unsigned char* base;
+    size_t size;
+    long count;            // records after the header
+    TraceSettings settings;
+} TraceReader;
+
+// Function prototypes
+int openTraceWriter(TraceWriter* w, const char* path, const TraceSettings* s);
+void traceWrite(TraceWriter* w, const TraceRecord* r);
+void closeTraceWriter(TraceWriter* w);
+int openTraceReader(TraceReader* r, const char* path);
+TraceRecord traceRecordAt(const TraceReader* r, long index);
+void closeTraceReader(TraceReader* r);
+
+#endif // SIM_TRACE_H
@@ -1,46 +1,44 @@
-// TODO: Optimize by using threads for concurrent processing
-// Example: pthread_create for light timer and vehicle processing
+// Threads (real-time mode):
+//   ingest    - owns the socket server / lane files, hands arrivals to the
+//               scheduler through a lock-free SPSC ring
+//   scheduler - the main thread: owns the timeline, light state and lane queues
+//   reporter  - drains a lock-free report ring and does all printing, so
+//               slow I/O never delays a tick
+// The event log has its own writer thread (see sim_log.h).
+// Renderers read the live state from shared memory (see state_channel.h).
+// --fast runs everything inline on one thread.
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#ifndef _WIN32
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sched.h>
 #include <unistd.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#endif
+#include <time.h>
+#include <signal.h>
 #include "queue.h"
+#include "intersection.h"
+#include "grid.h"
+#include "spsc_queue.h"
+#include "report_queue.h"
+#include "wait_stats.h"
+#include "event_queue.h"
+#include "lane_ingest.h"
+#include "net_server.h"
+#include "sim_trace.h"
+#include "state_channel.h"
+#include "sim_log.h"
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#include <windows.h>
-#pragma comment(lib, "ws2_32.lib")
-#define sleep(x) Sleep(x * 1000)
-#endif
-
-#include <errno.h>
-
-#ifdef _WIN32
-typedef SOCKET sock_t;
-#define CLOSE_SOCKET(s) closesocket(s)
-#define SOCKET_ERRNO() WSAGetLastError()
-#else
-typedef int sock_t;
-#define CLOSE_SOCKET(s) close(s)
-#define SOCKET_ERRNO() errno
-#endif
-
-typedef enum {
-    RED,
-    GREEN
-} LightState;
+#define GRID_SPAWN_PERMILLE 10   // --grid: new vehicles per junction per 1000 ticks
+#define LOAD_BATCH 64        // vehicles moved per queue batch operation
+#define ARRIVAL_RING_SIZE 4096   // ingest -> scheduler handoff
+#define REPORT_RING_SIZE 4096    // scheduler -> reporter handoff
+#define REPORT_IDLE_US 2000      // reporter nap when its ring is empty
+#define STDOUT_BUFFER (64 * 1024)
 
-#define NUM_LANES 4
-#define PRIORITY_LANE 0  // AL2 is lane A (index 0)
-#define GREEN_TIME 10    // seconds for green light
-#define RED_TIME 5       // seconds for red light
-#define VEHICLE_PASS_TIME 2  // seconds per vehicle
+_Static_assert(NUM_LANES <= REPORT_MAX_LANES, "status reports carry every lane");
 
 int estimate_pass_time(int vehicles) {
     return vehicles * VEHICLE_PASS_TIME;
@@ -53,267 +51,992 @@ const char* lane_files[NUM_LANES] = {
     "data/laned.txt"
 };
 
-Queue* vehicle_queues[NUM_LANES];
+Intersection junction;         // the simulated junction (owned by the scheduler)
+WaitHistogram lane_waits[NUM_LANES];
 
-void load_vehicles_from_file(int lane_index) {
-    FILE* fp = fopen(lane_files[lane_index], "r");
-    if (fp == NULL) {
-        perror("Error opening file");
-        return;
+// Where arriving vehicles come from
+typedef enum {
+    SOURCE_SOCKET,     // generators connect and stream arrival messages
+    SOURCE_FILES,      // tail the data/lane*.txt files
+    SOURCE_SYNTHETIC,  // built-in seeded arrivals, no external input
+    SOURCE_REPLAY      // arrivals from a recorded trace (--replay)
+} ArrivalSource;
+
+// Simulation options (see usage())
+typedef struct {
+    int port;
+    int fast;                  // headless: jump from event to event, no sleeping
+    int quiet;                 // suppress per-vehicle and periodic output
+    ArrivalSource source;
+    unsigned int seed;
+    unsigned int duration_ms;  // 0 = run forever
+    int grid_rows;             // --grid: simulate a city grid instead (0 = off)
+    int grid_cols;
+    int threads;               // worker threads for --grid
+    SchedulerKind scheduler;   // normal-condition lane policy
+    PriorityRule priority;
+    int adaptive;              // size green phases from the queues
+    const char* record_path;   // --record: write a binary trace of the run
+    const char* replay_path;   // --replay: re-run a trace and check its decisions
+    const char* log_path;      // structured event log (NULL: LOG_JSON_PATH or LOG_BINARY_PATH)
+    int log_level;             // LogLevel, -1 = info in real time, off with --fast
+    LogFormat log_format;
+    const char* dump_log_path; // --dump-log: print a binary log as JSON lines
+} SimOptions;
+
+SimOptions options = {8080, 0, 0, SOURCE_SOCKET, 1, 0, 0, 0, 1, SCHED_PROPORTIONAL, {0, 10, 5, DISPATCH_CAPACITY}, 0, NULL, NULL,
+                      NULL, -1, LOG_FORMAT_JSON, NULL};
+
+// Current simulation time: the timestamp of the event being handled.
+// Both modes advance it the same way, so decisions do not depend on wall time.
+unsigned int sim_time_ms = 0;
+
+// Microseconds of wall-clock time since the simulator started
+unsigned long long wall_clock_us() {
+    static struct timespec start;
+    struct timespec now;
+    if (start.tv_sec == 0 && start.tv_nsec == 0) clock_gettime(CLOCK_MONOTONIC, &start);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)((now.tv_sec - start.tv_sec) * 1000000LL + (now.tv_nsec - start.tv_nsec) / 1000);
+}
+
+// Milliseconds of wall-clock time since the simulator started
+unsigned int wall_clock_ms() {
+    return (unsigned int)(wall_clock_us() / 1000);
+}
+
+// printf unless running quietly
+void sim_print(const char* fmt, ...) {
+    if (options.quiet) return;
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+}
+
+// Parse one lane file line: "<id> [L|S|R]"
+int parse_vehicle(const char* line, int lane_index, unsigned int now, Vehicle* v) {
+    int id;
+    char turn = 'S';
+    if (sscanf(line, "%d %c", &id, &turn) < 1) return 0;
+    memset(v, 0, sizeof(*v));
+    v->id = id;
+    v->lane = (unsigned char)lane_index;
+    v->direction = (unsigned char)lane_directions[lane_index];
+    v->intent = turn == 'L' ? INTENT_LEFT : turn == 'R' ? INTENT_RIGHT : INTENT_STRAIGHT;
+    v->arrival_ms = now;
+    return 1;
+}
+
+// --- Thread handoff ---
+//
+// arrival_ring and report_ring only exist while the threads run; before that
+// (the initial lane file load) and in --fast mode everything happens inline.
+
+SpscQueue* arrival_ring;       // ingest thread -> scheduler
+ReportQueue* report_ring;      // scheduler -> reporter thread
+atomic_int threads_running;
+volatile sig_atomic_t stop_requested = 0; // SIGINT/SIGTERM: finish up and clean up
+long reports_dropped = 0;      // reports lost to a full ring (scheduler only)
+
+// The scheduler sleeps on wake_cond until its next event is due or the
+// ingest thread has handed over arrivals
+pthread_mutex_t wake_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t wake_cond;
+int wake_pending = 0;
+
+// Status text waiting for the ingest thread to send it to monitors
+pthread_mutex_t broadcast_lock = PTHREAD_MUTEX_INITIALIZER;
+char broadcast_text[1024];
+int broadcast_len = 0;
+
+void wake_scheduler() {
+    pthread_mutex_lock(&wake_lock);
+    wake_pending = 1;
+    pthread_cond_signal(&wake_cond);
+    pthread_mutex_unlock(&wake_lock);
+}
+
+// Ingest thread: pass one arrival to the scheduler, waiting while the ring is full
+void forward_arrival(Vehicle v) {
+    while (!spscEnqueue(arrival_ring, v) && atomic_load(&threads_running)) {
+        wake_scheduler();
+        sched_yield();
     }
-    char line[256];
-    while (fgets(line, sizeof(line), fp)) {
-        int id;
-        if (sscanf(line, "%d", &id) == 1) {
-            Vehicle v = {id};
-            enqueue(vehicle_queues[lane_index], v);
-        }
+}
+
+void write_report(const Report* r);
+void trace_arrival(const Vehicle* v);
+
+// Scheduler: hand a report to the reporter thread without blocking. If the
+// ring is full the report is dropped and counted rather than stalling a tick.
+void post_report(const Report* r) {
+    if (report_ring == NULL) {
+        write_report(r);
+    } else if (!reportEnqueue(report_ring, r)) {
+        reports_dropped++;
     }
-    fclose(fp);
 }
 
-int main(int argc, char* argv[]) {
-    // Initialize queues
-    for (int i = 0; i < NUM_LANES; i++) {
-        vehicle_queues[i] = createQueue();
-    }
-
-#ifdef _WIN32
-    WSADATA wsa;
-    WSAStartup(MAKEWORD(2,2), &wsa);
-#endif
-
-    sock_t server_sock = socket(AF_INET, SOCK_STREAM, 0);
-    struct sockaddr_in server_addr;
-    memset(&server_addr, 0, sizeof(server_addr));
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-
-    /* allow optional port via argv, default 8080 */
-    int port = 8080;
-    if (argc > 1) {
-        int p = atoi(argv[1]);
-        if (p > 0 && p < 65536) port = p;
-    }
-    server_addr.sin_port = htons(port);
-#ifdef _WIN32
-    if (server_sock == INVALID_SOCKET) {
-        fprintf(stderr, "socket() failed, WSA error: %d\n", SOCKET_ERRNO());
-        WSACleanup();
-        return 1;
+void post_simple_report(ReportType type, int lane, int value, const Vehicle* v) {
+    Report r;
+    r.type = type;
+    r.time_ms = sim_time_ms;
+    r.lane = lane;
+    r.value = value;
+    if (v) r.vehicle = *v;
+    post_report(&r);
+}
+
+// Lane file ingestion: only bytes appended since the last read are parsed,
+// collected into a batch and handed to the lane queue with enqueueBatch()
+// (or, once the threads run, to the scheduler through arrival_ring)
+LaneIngest lane_ingest;
+Vehicle ingest_batch[LOAD_BATCH];
+int ingest_count = 0;
+int ingest_lane = 0;
+
+void flush_ingest_batch() {
+    if (arrival_ring) {
+        for (int i = 0; i < ingest_count; i++) forward_arrival(ingest_batch[i]);
+    } else {
+        enqueueBatch(junction.lanes[ingest_lane], ingest_batch, ingest_count);
+        for (int i = 0; i < ingest_count; i++) trace_arrival(&ingest_batch[i]);
     }
+    ingest_count = 0;
+}
 
-    /* set SO_REUSEADDR so restarting quickly doesn't fail bind */
-#ifdef _WIN32
-    {
-        char reuse = 1;
-        setsockopt(server_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
-    }
-#else
-    {
-        int reuse = 1;
-        setsockopt(server_sock, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
-    }
-#endif
-
-    if (bind(server_sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) == SOCKET_ERROR) {
-#ifdef _WIN32
-        fprintf(stderr, "bind() failed on port %d, WSA error: %d\n", port, SOCKET_ERRNO());
-#else
-        fprintf(stderr, "bind() failed on port %d: ", port);
-        perror("");
-#endif
-        CLOSE_SOCKET(server_sock);
-#ifdef _WIN32
-        WSACleanup();
-#endif
-        return 1;
+void ingest_line(int lane_index, const char* line, void* ctx) {
+    (void)ctx;
+    if (ingest_count > 0 && lane_index != ingest_lane) flush_ingest_batch();
+    ingest_lane = lane_index;
+    // Arrival time is 0 for the initial load; later the scheduler stamps it
+    if (parse_vehicle(line, lane_index, 0, &ingest_batch[ingest_count])) {
+        if (++ingest_count == LOAD_BATCH) flush_ingest_batch();
     }
+}
 
-    if (listen(server_sock, 5) == SOCKET_ERROR) {
-        fprintf(stderr, "listen() failed, WSA error: %d\n", SOCKET_ERRNO());
-        CLOSE_SOCKET(server_sock);
-        WSACleanup();
-        return 1;
+// Load vehicles appended to the lane files that changed since the last call
+int load_new_vehicles() {
+    int lines = ingestChanged(&lane_ingest, ingest_line, NULL);
+    flush_ingest_batch();
+    return lines;
+}
+
+// --- Event-driven engine ---
+//
+// Everything the simulator does is an event on one timeline: light changes,
+// arrivals, green-phase dispatch slots, lane file polls and status reports.
+// Real-time mode sleeps until each event is due; --fast skips the sleeping,
+// so both modes make the same decisions for the same arrivals. Dispatch slots
+// fall on whole seconds (the original 1 s tick) and are only scheduled while
+// the light is green and some lane has vehicles, so idle time costs nothing.
+// In real-time mode the lateness of every event is recorded as tick jitter.
+
+#define TICK_MS 1000
+#define STATUS_INTERVAL_MS 5000
+#define POLL_INTERVAL_MS 1000   // lane file check when inotify is unavailable
+#define SYNTH_BASE_INTERVAL 2   // synthetic arrivals mirror traffic_generator
+#define SYNTH_PRIORITY_BOOST 1
+
+EventQueue* timeline;
+int departure_pending = 0;     // an EV_DEPARTURE is already on the timeline
+unsigned int light_event_seq;  // the EV_LIGHT_CHANGE still in force; earlier ones are stale
+NetServer net_server;
+SimLog sim_log;                // scheduler thread posts, its own thread writes
+unsigned int synth_state;      // xorshift32 state for synthetic arrivals
+int synth_next_id = 1;
+long events_handled = 0;
+WaitHistogram tick_jitter;     // event lateness in microseconds (real-time mode)
+
+// --- Decision trace (--record / --replay) ---
+//
+// Recording appends every arrival the scheduler enqueues and every decision
+// it makes. An arrival is tagged with the number of timeline events handled
+// before it (arrival events aside), which pins down where it fell between
+// decisions whichever thread or event delivered it. Replay injects each
+// arrival at the same point and checks every decision against the trace.
+TraceWriter trace_out;
+TraceReader trace_in;
+long trace_pos = 0;            // replay: next record to inject or check
+long trace_step = 0;           // non-arrival timeline events handled
+long replay_arrivals = 0;
+long replay_decisions = 0;
+int replay_diverged = 0;
+
+void trace_arrival(const Vehicle* v) {
+    if (trace_out.fp == NULL) return;
+    TraceRecord r = {TRACE_ARRIVAL, v->lane, v->intent, sim_time_ms, (unsigned int)v->id, (unsigned int)trace_step};
+    traceWrite(&trace_out, &r);
+}
+
+const char* trace_type_name(int type) {
+    switch (type) {
+        case TRACE_ARRIVAL: return "arrival";
+        case TRACE_PASS:    return "pass";
+        case TRACE_LIGHT:   return "light";
+        case TRACE_END:     return "end";
+        default:            return "?";
     }
-    printf("Simulator listening on port %d\n", port);
+}
 
-    struct sockaddr_in client_addr;
-    int client_len = sizeof(client_addr);
-    sock_t client_sock = accept(server_sock, (struct sockaddr*)&client_addr, &client_len);
-    if (client_sock == INVALID_SOCKET) {
-        fprintf(stderr, "Accept failed, WSA error: %d\n", SOCKET_ERRNO());
-        CLOSE_SOCKET(server_sock);
-        WSACleanup();
-        return 1;
+void print_trace_record(const char* label, const TraceRecord* r) {
+    fprintf(stderr, "  %-9s %-7s t=%u ms lane %c value %u id %u aux %u\n", label, trace_type_name(r->type),
+            r->time_ms, 'A' + r->lane, r->value, r->id, r->aux);
+}
+
+// Record a decision, or when replaying check it is the one recorded next
+void trace_decision(TraceType type, int lane, int value, unsigned int id, unsigned int aux) {
+    TraceRecord r = {(unsigned char)type, (unsigned char)lane, (unsigned char)value, sim_time_ms, id, aux};
+    if (trace_out.fp) {
+        traceWrite(&trace_out, &r);
+        return;
     }
-#else
-    if (server_sock < 0) {
-        perror("socket() failed");
-        return 1;
+    if (options.source != SOURCE_REPLAY || replay_diverged) return;
+    TraceRecord want;
+    if (trace_pos < trace_in.count) {
+        want = traceRecordAt(&trace_in, trace_pos);
+    } else {
+        memset(&want, 0, sizeof(want));
     }
-
-    if (bind(server_sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        perror("bind() failed");
-        CLOSE_SOCKET(server_sock);
-        return 1;
+    if (want.type != r.type || want.lane != r.lane || want.value != r.value || want.time_ms != r.time_ms ||
+        want.id != r.id || want.aux != r.aux) {
+        fprintf(stderr, "Replay diverged at record %ld:\n", trace_pos);
+        print_trace_record("recorded", &want);
+        print_trace_record("replayed", &r);
+        replay_diverged = 1;
+        return;
     }
+    trace_pos++;
+    replay_decisions++;
+}
 
-    if (listen(server_sock, 5) < 0) {
-        perror("listen() failed");
-        CLOSE_SOCKET(server_sock);
-        return 1;
+// --- Live state channel (real-time mode) ---
+//
+// The scheduler keeps a staged snapshot and publishes it to shared memory
+// after every event it handles, so renderers always see the current light
+// and queues without reading a file.
+StateBlock* state_shm = NULL;
+StateSnapshot state_snap;
+
+// A vehicle passed: add it to the recent passes and refresh its lane's waits
+void stage_pass(const Vehicle* v, int from_priority) {
+    if (state_shm == NULL) return;
+    StateDispatch* d = &state_snap.recent[state_snap.passed % STATE_RECENT];
+    d->lane = v->lane;
+    d->from_priority = from_priority;
+    d->vehicle = (unsigned int)v->id;
+    d->time_ms = v->departure_ms;
+    d->wait_ms = v->departure_ms - v->arrival_ms;
+    state_snap.passed++;
+    const WaitHistogram* h = &lane_waits[v->lane];
+    state_snap.served[v->lane] = h->count;
+    state_snap.p50_ms[v->lane] = waitPercentile(h, 0.50);
+    state_snap.p99_ms[v->lane] = waitPercentile(h, 0.99);
+    state_snap.max_ms[v->lane] = h->max_ms;
+}
+
+void publish_state() {
+    if (state_shm == NULL) return;
+    state_snap.time_ms = sim_time_ms;
+    state_snap.light = junction.light == GREEN;
+    state_snap.light_left_ms = junction.light_change_at > sim_time_ms ? junction.light_change_at - sim_time_ms : 0;
+    state_snap.priority_lane = junction.priority_lane;
+    for (int i = 0; i < NUM_LANES; i++) state_snap.queue[i] = getSize(junction.lanes[i]);
+    publishState(state_shm, &state_snap);
+}
+
+void schedule(EventType type, unsigned int time_ms) {
+    SimEvent ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.type = type;
+    ev.time_ms = time_ms;
+    pushEvent(timeline, ev);
+}
+
+// Schedule the next light change, superseding any already on the timeline
+void schedule_light_change(unsigned int time_ms) {
+    light_event_seq = timeline->next_seq;
+    schedule(EV_LIGHT_CHANGE, time_ms);
+}
+
+// Make sure a dispatch slot is pending at the next whole second (and, if an
+// adaptive light is resting on RED, that it turns GREEN then)
+void wake_dispatch() {
+    unsigned int slot = (sim_time_ms + TICK_MS - 1) / TICK_MS * TICK_MS;
+    if (slot == 0) slot = TICK_MS; // the first tick is at t=1s
+    if (demandGreen(&junction, slot)) schedule_light_change(slot);
+    if (departure_pending || junction.light != GREEN) return;
+    schedule(EV_DEPARTURE, slot);
+    departure_pending = 1;
+}
+
+unsigned int synth_random() {
+    synth_state ^= synth_state << 13;
+    synth_state ^= synth_state >> 17;
+    synth_state ^= synth_state << 5;
+    return synth_state;
+}
+
+// Schedule the next synthetic vehicle (random lane, 2-4 s apart)
+void schedule_synthetic_arrival() {
+    SimEvent ev;
+    memset(&ev, 0, sizeof(ev));
+    int lane = synth_random() % NUM_LANES;
+    if (lane != 0 && synth_random() % 10 < SYNTH_PRIORITY_BOOST) lane = 0;
+    ev.type = EV_ARRIVAL;
+    ev.time_ms = sim_time_ms + (SYNTH_BASE_INTERVAL + synth_random() % 3) * 1000;
+    ev.vehicle.id = synth_next_id++;
+    ev.vehicle.lane = (unsigned char)lane;
+    ev.vehicle.direction = (unsigned char)lane_directions[lane];
+    ev.vehicle.intent = INTENT_STRAIGHT;
+    pushEvent(timeline, ev);
+}
+
+void handle_light_change(const SimEvent* ev) {
+    // Adaptive timing may have moved the change since this event was queued
+    if (ev->seq != light_event_seq) return;
+    LightState before = junction.light;
+    if (changeLight(&junction, sim_time_ms) == GREEN && intersectionWaiting(&junction)) wake_dispatch();
+    trace_decision(TRACE_LIGHT, 0, junction.phase.resting ? TRACE_LIGHT_RESTING : (int)junction.light, 0,
+                   junction.light_change_at);
+    if (junction.phase.resting) {
+        SIM_LOG(&sim_log, LOG_INFO, LOG_EV_LIGHT, 0, 2, sim_time_ms, 0, 0);
+        post_simple_report(REPORT_LIGHT, 0, -1, NULL);
+        return; // the next arrival plans the green phase
+    }
+    if (junction.light != before) {
+        SIM_LOG(&sim_log, LOG_INFO, LOG_EV_LIGHT, 0, junction.light == GREEN, sim_time_ms, 0, junction.light_change_at);
+        post_simple_report(REPORT_LIGHT, 0, junction.light == GREEN, NULL);
     }
-    printf("Simulator listening on port 8080\n");
+    schedule_light_change(junction.light_change_at);
+}
 
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
-    sock_t client_sock = accept(server_sock, (struct sockaddr*)&client_addr, &client_len);
-    if (client_sock < 0) {
-        perror("Accept failed");
-        CLOSE_SOCKET(server_sock);
-        return 1;
+// Scheduler: take everything the ingest thread has handed over
+int drain_arrivals() {
+    Vehicle batch[LOAD_BATCH];
+    int total = 0;
+    int n;
+    while ((n = spscDequeueBatch(arrival_ring, batch, LOAD_BATCH)) > 0) {
+        for (int k = 0; k < n; k++) {
+            Vehicle v = batch[k];
+            v.direction = (unsigned char)lane_directions[v.lane];
+            v.arrival_ms = sim_time_ms;
+            enqueue(junction.lanes[v.lane], v);
+            trace_arrival(&v);
+            SIM_LOG(&sim_log, LOG_DEBUG, LOG_EV_ARRIVAL, v.lane, 0, sim_time_ms, (unsigned int)v.id, 0);
+            if (options.source == SOURCE_SOCKET) post_simple_report(REPORT_ARRIVAL, v.lane, 0, &v);
+        }
+        total += n;
     }
-#endif
-    printf("Generator connected.\n");
+    return total;
+}
+
+void handle_arrival(SimEvent* ev) {
+    ev->vehicle.arrival_ms = sim_time_ms;
+    enqueue(junction.lanes[ev->vehicle.lane], ev->vehicle);
+    trace_arrival(&ev->vehicle);
+    SIM_LOG(&sim_log, LOG_DEBUG, LOG_EV_ARRIVAL, ev->vehicle.lane, 0, sim_time_ms, (unsigned int)ev->vehicle.id, 0);
+    wake_dispatch();
+    if (options.source == SOURCE_SYNTHETIC) schedule_synthetic_arrival();
+}
 
-    FILE* log_fp = fopen("simulation_log.txt", "a");
-    if (log_fp) {
-        fprintf(log_fp, "Simulation started at %s\n", __DATE__ " " __TIME__);
+// One green-phase dispatch slot
+void handle_departure() {
+    departure_pending = 0;
+    if (junction.light != GREEN) return;
+
+    Vehicle passed[DISPATCH_CAPACITY];
+    DispatchResult d = dispatchIntersection(&junction, sim_time_ms, passed);
+    if (d.priority_on) {
+        SIM_LOG(&sim_log, LOG_INFO, LOG_EV_PRIORITY_ON, junction.priority.lane, 0, sim_time_ms, 0, d.priority_size);
+        post_simple_report(REPORT_PRIORITY_ON, junction.priority.lane, d.priority_size, NULL);
+    }
+    if (d.to_serve >= 0) post_simple_report(REPORT_ESTIMATE, 0, d.to_serve, NULL);
+    for (int k = 0; k < d.passed; k++) {
+        recordDeparture(&lane_waits[passed[k].lane], &passed[k]);
+        stage_pass(&passed[k], d.from_priority);
+        SIM_LOG(&sim_log, LOG_DEBUG, LOG_EV_PASS, passed[k].lane, d.from_priority, sim_time_ms,
+                (unsigned int)passed[k].id, passed[k].departure_ms - passed[k].arrival_ms);
+        trace_decision(TRACE_PASS, passed[k].lane, d.from_priority, (unsigned int)passed[k].id, 0);
+        post_simple_report(REPORT_PASSED, passed[k].lane, d.from_priority, &passed[k]);
+    }
+    if (d.priority_off) {
+        SIM_LOG(&sim_log, LOG_INFO, LOG_EV_PRIORITY_OFF, junction.priority.lane, 0, sim_time_ms, 0, 0);
+        post_simple_report(REPORT_PRIORITY_OFF, junction.priority.lane, junction.priority.leave_below, NULL);
     }
+    if (gapOut(&junction, sim_time_ms)) schedule_light_change(junction.light_change_at);
 
-    // Load initial vehicles and truncate the files so generator won't duplicate entries
-    for (int i = 0; i < NUM_LANES; i++) {
-        load_vehicles_from_file(i);
-        // truncate file after loading to indicate we've consumed entries
-        FILE* tf = fopen(lane_files[i], "w");
-        if (tf) fclose(tf);
+    if (intersectionWaiting(&junction) && sim_time_ms + TICK_MS < junction.light_change_at) {
+        schedule(EV_DEPARTURE, sim_time_ms + TICK_MS);
+        departure_pending = 1;
     }
+}
 
-    printf("Initial load complete.\n");
+// Scheduler side of the status report: snapshot the numbers only
+void handle_status() {
+    Report r;
+    r.type = REPORT_STATUS;
+    r.time_ms = sim_time_ms;
+    r.lane = 0;
+    r.value = junction.light == GREEN;
+    r.light_left_ms = junction.light_change_at > sim_time_ms ? junction.light_change_at - sim_time_ms : 0;
     for (int i = 0; i < NUM_LANES; i++) {
-        printf("Lane %c: %d vehicles\n", 'A' + i, getSize(vehicle_queues[i]));
+        QueueStats qs = getQueueStats(junction.lanes[i]);
+        LaneSnapshot* ls = &r.lanes[i];
+        ls->size = getSize(junction.lanes[i]);
+        ls->high_water = qs.high_water;
+        ls->capacity = qs.capacity;
+        ls->reuse_ratio = qs.reuse_ratio;
+        ls->served = lane_waits[i].count;
+        ls->p50_ms = waitPercentile(&lane_waits[i], 0.50);
+        ls->p99_ms = waitPercentile(&lane_waits[i], 0.99);
+        ls->max_ms = lane_waits[i].max_ms;
+        SIM_LOG(&sim_log, LOG_INFO, LOG_EV_QUEUE, i, 0, sim_time_ms, 0, (unsigned int)ls->size);
     }
+    post_report(&r);
+    schedule(EV_STATUS, sim_time_ms + STATUS_INTERVAL_MS);
+}
 
-    // Simple state for priority lane (-1 means none)
-    int priority_lane = -1;
+// Reporter side of the status report: print, broadcast, log
+void write_status(const Report* r) {
+    // Build the status text once: printed locally and sent to monitors
+    char text[1024];
+    int len = snprintf(text, sizeof(text), "Light: %s (%u sec left), Queues:\n",
+                       r->value ? "GREEN" : "RED", r->light_left_ms / 1000);
+    for (int i = 0; i < NUM_LANES && len < (int)sizeof(text); i++) {
+        const LaneSnapshot* ls = &r->lanes[i];
+        len += snprintf(text + len, sizeof(text) - len,
+                        "Lane %c: %d vehicles (peak %d, %d slots, %.0f%% reuse)\n"
+                        "  wait: %lu served, p50 %.1fs, p99 %.1fs, max %.1fs\n", 'A' + i,
+                        ls->size, ls->high_water, ls->capacity, ls->reuse_ratio * 100,
+                        ls->served, ls->p50_ms / 1000.0, ls->p99_ms / 1000.0, ls->max_ms / 1000.0);
+    }
+    if (len > (int)sizeof(text) - 1) len = (int)sizeof(text) - 1;
+    sim_print("%s", text);
+    if (options.source == SOURCE_SOCKET) {
+        // The ingest thread owns the sockets; leave the text for it
+        pthread_mutex_lock(&broadcast_lock);
+        memcpy(broadcast_text, text, len);
+        broadcast_len = len;
+        pthread_mutex_unlock(&broadcast_lock);
+        netServerWake(&net_server);
+    }
+}
 
-    // Traffic light state
-    LightState current_light = GREEN;
-    int light_timer = GREEN_TIME;
+// Turn a report into output. Runs on the reporter thread (inline in --fast).
+void write_report(const Report* r) {
+    switch (r->type) {
+        case REPORT_LIGHT:
+            if (r->value < 0) {
+                sim_print("No vehicles waiting, light stays RED\n");
+            } else {
+                sim_print("Light turned %s\n", r->value ? "GREEN" : "RED");
+            }
+            break;
+        case REPORT_ARRIVAL:
+            sim_print("Socket: Vehicle %d to lane %c\n", r->vehicle.id, 'A' + r->lane);
+            break;
+        case REPORT_PASSED:
+            sim_print("Vehicle %d passed from %s %c\n", r->vehicle.id, r->value ? "priority lane" : "lane", 'A' + r->lane);
+            break;
+        case REPORT_PRIORITY_ON:
+            sim_print("Priority lane detected: %c (size=%d)\n", 'A' + r->lane, r->value);
+            break;
+        case REPORT_PRIORITY_OFF:
+            sim_print("Priority lane %c dropped below %d, returning to normal scheduling\n", 'A' + r->lane, r->value);
+            break;
+        case REPORT_ESTIMATE:
+            sim_print("Estimated pass time for %d vehicles: %d seconds\n", r->value, estimate_pass_time(r->value));
+            break;
+        case REPORT_STATUS:
+            write_status(r);
+            break;
+    }
+}
 
-    // Simulate polling and processing (optimized to 1s for responsiveness)
-    while (1) {
-        sleep(1); // Poll every 1 second for finer control
+// --- Threads ---
 
-        // Socket: Read from client
-        char buffer[256];
-        int bytes = recv(client_sock, buffer, sizeof(buffer) - 1, 0);
-        if (bytes > 0) {
-            buffer[bytes] = '\0';
-            printf("Socket: %s", buffer);
-        }
+// A generator connection delivered an arrival message (ingest thread)
+void socket_arrival(Vehicle v, void* ctx) {
+    (void)ctx;
+    forward_arrival(v);
+}
 
-        // Update light timer
-        light_timer--;
-        if (light_timer <= 0) {
-            if (current_light == GREEN) {
-                current_light = RED;
-                light_timer = RED_TIME;
-                printf("Light turned RED\n");
+void* ingest_main(void* arg) {
+    (void)arg;
+    while (atomic_load(&threads_running)) {
+        int arrivals;
+        if (options.source == SOURCE_SOCKET) {
+            netServerWait(&net_server, -1); // netServerWake interrupts it
+            arrivals = netServerPoll(&net_server, socket_arrival, NULL);
+            pthread_mutex_lock(&broadcast_lock);
+            if (broadcast_len > 0) netServerBroadcast(&net_server, broadcast_text, broadcast_len);
+            broadcast_len = 0;
+            pthread_mutex_unlock(&broadcast_lock);
+        } else {
+            if (lane_ingest.notify_fd >= 0) {
+                ingestWait(&lane_ingest, POLL_INTERVAL_MS);
             } else {
-                current_light = GREEN;
-                light_timer = GREEN_TIME;
-                printf("Light turned GREEN\n");
+                usleep(POLL_INTERVAL_MS * 1000);
             }
+            arrivals = load_new_vehicles();
         }
+        if (arrivals > 0) wake_scheduler();
+    }
+    return NULL;
+}
 
-        // Load any new vehicles appended by generator and truncate
-        for (int i = 0; i < NUM_LANES; i++) {
-            load_vehicles_from_file(i);
-            FILE* tf = fopen(lane_files[i], "w");
-            if (tf) fclose(tf);
+void* reporter_main(void* arg) {
+    (void)arg;
+    Report r;
+    for (;;) {
+        // Everything posted before the stop flag is still written
+        int stopping = !atomic_load(&threads_running);
+        while (reportDequeue(report_ring, &r)) write_report(&r);
+        if (stopping) break;
+        // The signal handler cannot touch the condition variable, so the
+        // reporter passes a stop request on to a sleeping scheduler
+        if (stop_requested) wake_scheduler();
+        fflush(stdout);
+        usleep(REPORT_IDLE_US);
+    }
+    fflush(stdout);
+    return NULL;
+}
+
+// Real-time mode: sleep until target_ms, but wake early when the ingest
+// thread hands over arrivals. Returns 1 if it was woken (the timeline may
+// have gained earlier events), 0 once target_ms is reached.
+int wait_for_input(unsigned int target_ms) {
+    pthread_mutex_lock(&wake_lock);
+    while (!wake_pending) {
+        long long remaining_us = (long long)target_ms * 1000 - (long long)wall_clock_us();
+        if (remaining_us <= 0) break;
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += remaining_us / 1000000;
+        deadline.tv_nsec += (remaining_us % 1000000) * 1000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
         }
+        pthread_cond_timedwait(&wake_cond, &wake_lock, &deadline);
+    }
+    int woken = wake_pending;
+    wake_pending = 0;
+    pthread_mutex_unlock(&wake_lock);
+    if (!woken) return 0;
 
-        // Process vehicles only when light is green
-        if (current_light == GREEN) {
-            // Detect priority lane: only AL2 (lane A) can be priority if >10 vehicles
-            if (priority_lane == -1) {
-                if (getSize(vehicle_queues[PRIORITY_LANE]) > 10) {
-                    priority_lane = PRIORITY_LANE;
-                    printf("Priority lane detected: %c (size=%d)\n", 'A' + PRIORITY_LANE, getSize(vehicle_queues[PRIORITY_LANE]));
-                }
-            }
+    unsigned int now = wall_clock_ms();
+    sim_time_ms = now < target_ms ? now : target_ms;
+    if (drain_arrivals() > 0 && intersectionWaiting(&junction)) wake_dispatch();
+    return 1;
+}
 
-            // If we have a priority lane, serve it until size < 5
-            if (priority_lane != -1) {
-                if (!isEmpty(vehicle_queues[priority_lane])) {
-                    Vehicle v = dequeue(vehicle_queues[priority_lane]);
-                    printf("Vehicle %d passed from priority lane %c\n", v.id, 'A' + priority_lane);
-                }
-                if (getSize(vehicle_queues[priority_lane]) < 5) {
-                    printf("Priority lane %c dropped below 5, returning to normal scheduling\n", 'A' + priority_lane);
-                    priority_lane = -1;
-                }
-            } else {
-                // Normal scheduling: serve proportionally as per formula |V| = (1/n) * sum Li
-                int total_vehicles = 0;
-                for (int i = 0; i < NUM_LANES; i++) total_vehicles += getSize(vehicle_queues[i]);
-                int n = NUM_LANES;
-                int vehicles_to_serve = total_vehicles / n;
-                if (vehicles_to_serve < 1 && total_vehicles > 0) vehicles_to_serve = 1;
-
-                int estimated_time = estimate_pass_time(vehicles_to_serve);
-                printf("Estimated pass time for %d vehicles: %d seconds\n", vehicles_to_serve, estimated_time); // ensure progress
-
-                // Distribute proportionally, but simplified to round-robin for now
-                int served = 0;
-                for (int attempt = 0; attempt < NUM_LANES && served < vehicles_to_serve; attempt++) {
-                    int i = attempt % NUM_LANES;
-                    if (!isEmpty(vehicle_queues[i])) {
-                        Vehicle v = dequeue(vehicle_queues[i]);
-                        printf("Vehicle %d passed from lane %c\n", v.id, 'A' + i);
-                        served++;
-                    }
-                }
-            }
+// Replay: enqueue the recorded arrivals that came before the next event.
+// Returns 0 once the run should stop (end of trace or a divergence).
+int inject_replay_arrivals() {
+    while (!replay_diverged && trace_pos < trace_in.count) {
+        TraceRecord r = traceRecordAt(&trace_in, trace_pos);
+        if (r.type == TRACE_END && r.aux == (unsigned int)trace_step) return 0;
+        if (r.type != TRACE_ARRIVAL || r.aux != (unsigned int)trace_step) return 1;
+        if (r.lane >= NUM_LANES) {
+            fprintf(stderr, "Replay: bad lane in record %ld\n", trace_pos);
+            replay_diverged = 1;
+            break;
+        }
+        Vehicle v;
+        memset(&v, 0, sizeof(v));
+        v.id = (int)r.id;
+        v.lane = r.lane;
+        v.direction = (unsigned char)lane_directions[r.lane];
+        v.intent = r.value;
+        v.arrival_ms = r.time_ms;
+        sim_time_ms = r.time_ms;
+        enqueue(junction.lanes[v.lane], v);
+        wake_dispatch();
+        trace_pos++;
+        replay_arrivals++;
+    }
+    return !replay_diverged && trace_pos < trace_in.count;
+}
+
+// Run the timeline until it empties or the requested duration is reached
+void run_simulation() {
+    while (!stop_requested && !isEventQueueEmpty(timeline)) {
+        if (options.source == SOURCE_REPLAY && !inject_replay_arrivals()) break;
+        if (options.duration_ms && peekEvent(timeline)->time_ms > options.duration_ms) break;
+        if (!options.fast && wait_for_input(peekEvent(timeline)->time_ms)) {
+            publish_state();
+            continue;
         }
+        SimEvent ev = popEvent(timeline);
+        sim_time_ms = ev.time_ms;
+        events_handled++;
+        if (ev.type != EV_ARRIVAL) trace_step++;
+        if (!options.fast) {
+            long long late_us = (long long)wall_clock_us() - (long long)ev.time_ms * 1000;
+            recordWait(&tick_jitter, late_us > 0 ? (unsigned int)late_us : 0);
+        }
+        switch (ev.type) {
+            case EV_LIGHT_CHANGE: handle_light_change(&ev); break;
+            case EV_ARRIVAL:      handle_arrival(&ev); break;
+            case EV_DEPARTURE:    handle_departure(); break;
+            case EV_STATUS:       handle_status(); break;
+        }
+        publish_state();
+    }
+}
+
+void print_summary(unsigned int wall_ms) {
+    printf("Simulated %.1f s in %u ms wall time (%ld events)\n", sim_time_ms / 1000.0, wall_ms, events_handled);
+    for (int i = 0; i < NUM_LANES; i++) {
+        printf("Lane %c: %lu served, %d waiting, wait p50 %.1fs p99 %.1fs max %.1fs mean %.1fs\n", 'A' + i,
+               lane_waits[i].count, getSize(junction.lanes[i]),
+               waitPercentile(&lane_waits[i], 0.50) / 1000.0, waitPercentile(&lane_waits[i], 0.99) / 1000.0,
+               lane_waits[i].max_ms / 1000.0, waitMean(&lane_waits[i]) / 1000.0);
+    }
+    if (tick_jitter.count > 0) {
+        printf("Scheduler tick jitter: %lu events, p50 %u us, p99 %u us, max %u us\n", tick_jitter.count,
+               waitPercentile(&tick_jitter, 0.50), waitPercentile(&tick_jitter, 0.99), tick_jitter.max_ms);
+    }
+    if (reports_dropped > 0) printf("Reports dropped (reporter fell behind): %ld\n", reports_dropped);
+}
+
+void usage(const char* prog) {
+    fprintf(stderr,
+            "Usage: %s [port] [--files] [--fast] [--duration SECONDS] [--seed N] [--quiet]\n"
+            "          [--scheduler NAME] [--priority LANE:ENTER:LEAVE[:PER_SLOT] | --priority none] [--adaptive]\n"
+            "          [--record FILE] [--log FILE] [--log-level LEVEL] [--log-format json|binary]\n"
+            "       %s --replay FILE\n"
+            "       %s --dump-log FILE\n"
+            "       %s --grid ROWSxCOLS [--threads N] --duration SECONDS\n"
+            "  port          TCP port generators and monitors connect to (default 8080)\n"
+            "  --files       read arrivals from data/lane*.txt instead of the socket\n"
+            "  --fast        headless fast-forward: no socket, no sleeping\n"
+            "  --duration S  stop after S seconds of simulated time\n"
+            "  --seed N      use built-in seeded arrivals instead of generators\n"
+            "  --quiet       only print the final summary\n"
+            "  --scheduler   roundrobin, proportional (default), drr or maxpressure\n"
+            "  --priority    priority lane rule (default A:10:5:4; 1 <= LEAVE <= ENTER), or none\n"
+            "  --adaptive    size each green phase from the queues (3-30 s) instead of 10 s\n"
+            "  --record F    write every arrival and decision to the binary trace F\n"
+            "  --replay F    re-run trace F at full speed and check every decision matches\n"
+            "  --log F       event log file (default simulation_log.txt, .bin for binary)\n"
+            "  --log-level   off, error, warn, info (default; off with --fast) or debug (every vehicle)\n"
+            "  --log-format  json lines (default) or binary records\n"
+            "  --dump-log F  print binary log F as JSON lines\n"
+            "  --grid RxC    headless city grid of R x C junctions\n"
+            "  --threads N   worker threads for --grid (default 1)\n",
+            prog, prog, prog, prog);
+}
+
+// "A:10:5" or "A:10:5:2" (lane, enter above, leave below, vehicles per slot), or "none"
+int parse_priority_rule(const char* spec, PriorityRule* rule) {
+    if (strcmp(spec, "none") == 0) {
+        rule->lane = -1;
+        return 0;
+    }
+    char lane;
+    int per_slot = DISPATCH_CAPACITY;
+    int fields = sscanf(spec, "%c:%d:%d:%d", &lane, &rule->enter_above, &rule->leave_below, &per_slot);
+    if (fields < 3 || lane < 'A' || lane >= 'A' + NUM_LANES || per_slot < 1) return 1;
+    // LEAVE 0 could never be reached (the lane would keep priority forever)
+    // and LEAVE above ENTER would drop priority as soon as it was taken
+    if (rule->leave_below < 1 || rule->leave_below > rule->enter_above) {
+        fprintf(stderr, "--priority %s: LEAVE must be between 1 and ENTER\n", spec);
+        return 1;
+    }
+    rule->lane = lane - 'A';
+    rule->per_slot = per_slot;
+    return 0;
+}
 
-        // Status every 5 seconds
-        static int status_timer = 0;
-        status_timer++;
-        if (status_timer >= 5) {
-            status_timer = 0;
-            printf("Light: %s (%d sec left), Queues:\n", current_light == GREEN ? "GREEN" : "RED", light_timer);
-            for (int i = 0; i < NUM_LANES; i++) {
-                printf("Lane %c: %d vehicles\n", 'A' + i, getSize(vehicle_queues[i]));
-                if (log_fp) {
-                    fprintf(log_fp, "Lane %c: %d vehicles\n", 'A' + i, getSize(vehicle_queues[i]));
-                    fflush(log_fp);
-                }
+int parse_options(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--fast") == 0) {
+            options.fast = 1;
+            options.source = SOURCE_SYNTHETIC;
+        } else if (strcmp(argv[i], "--files") == 0) {
+            options.source = SOURCE_FILES;
+        } else if (strcmp(argv[i], "--adaptive") == 0) {
+            options.adaptive = 1;
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            options.quiet = 1;
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            options.duration_ms = (unsigned int)(atof(argv[++i]) * 1000);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+            options.source = SOURCE_SYNTHETIC;
+        } else if (strcmp(argv[i], "--grid") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &options.grid_rows, &options.grid_cols) != 2 ||
+                options.grid_rows < 1 || options.grid_cols < 1) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--scheduler") == 0 && i + 1 < argc) {
+            int kind = schedulerKindFromName(argv[++i]);
+            if (kind < 0) {
+                fprintf(stderr, "Unknown scheduler: %s\n", argv[i]);
+                return 1;
             }
-            // Write graphics state file so external renderer can display counts
-            {
-                FILE* gs = fopen("data/graphics_state.txt", "w");
-                if (gs) {
-                    for (int i = 0; i < NUM_LANES; i++) {
-                        fprintf(gs, "%d\n", getSize(vehicle_queues[i]));
-                    }
-                    fclose(gs);
-                }
+            options.scheduler = (SchedulerKind)kind;
+        } else if (strcmp(argv[i], "--priority") == 0 && i + 1 < argc) {
+            if (parse_priority_rule(argv[++i], &options.priority)) {
+                usage(argv[0]);
+                return 1;
             }
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options.record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options.replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            options.log_path = argv[++i];
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            options.log_level = logLevelFromName(argv[++i]);
+            if (options.log_level < 0) {
+                fprintf(stderr, "Unknown log level: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--log-format") == 0 && i + 1 < argc) {
+            int format = logFormatFromName(argv[++i]);
+            if (format < 0) {
+                fprintf(stderr, "Unknown log format: %s\n", argv[i]);
+                return 1;
+            }
+            options.log_format = (LogFormat)format;
+        } else if (strcmp(argv[i], "--dump-log") == 0 && i + 1 < argc) {
+            options.dump_log_path = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            /* allow optional port via argv, default 8080 */
+            int p = atoi(argv[i]);
+            if (p > 0 && p < 65536) options.port = p;
+        } else {
+            usage(argv[0]);
+            return 1;
         }
     }
+    if (options.replay_path) {
+        // The trace decides when the run ends
+        options.source = SOURCE_REPLAY;
+        options.fast = 1;
+        options.quiet = 1;
+        options.duration_ms = 0;
+        options.record_path = NULL;
+    } else if (options.fast && options.duration_ms == 0) {
+        fprintf(stderr, "--fast needs --duration\n");
+        return 1;
+    }
+    if (options.grid_rows && options.duration_ms == 0) {
+        fprintf(stderr, "--grid needs --duration\n");
+        return 1;
+    }
+    return 0;
+}
 
-    // Cleanup
-    for (int i = 0; i < NUM_LANES; i++) {
-        freeQueue(vehicle_queues[i]);
-    }
-    if (log_fp) fclose(log_fp);
-    closesocket(client_sock);
-    closesocket(server_sock);
-#ifdef _WIN32
-    WSACleanup();
-#endif
+// --grid: run the sharded city grid headless and print its totals
+int run_grid() {
+    Grid* g = createGrid(options.grid_rows, options.grid_cols, options.threads, GRID_SPAWN_PERMILLE);
+    unsigned long long t0 = wall_clock_us();
+    runGrid(g, options.duration_ms);
+    double secs = (wall_clock_us() - t0) / 1e6;
+
+    GridStats gs;
+    getGridStats(g, &gs);
+    printf("Grid %dx%d (%d junctions) on %d thread(s): simulated %.1f s in %.3f s wall time\n",
+           g->rows, g->cols, g->rows * g->cols, g->shard_count, g->now_ms / 1000.0, secs);
+    printf("Vehicles: %ld entered, %ld left the grid, %ld still on it\n", gs.spawned, gs.exited, gs.queued);
+    printf("Junction wait: %lu passes, p50 %.1fs p99 %.1fs max %.1fs mean %.1fs\n", gs.waits.count,
+           waitPercentile(&gs.waits, 0.50) / 1000.0, waitPercentile(&gs.waits, 0.99) / 1000.0,
+           gs.waits.max_ms / 1000.0, waitMean(&gs.waits) / 1000.0);
+    printf("Throughput: %.2f M junction-ticks/s\n", gs.intersection_ticks / secs / 1e6);
+    freeGrid(g);
+    return 0;
+}
+
+// --dump-log: print a binary event log as JSON lines
+int dump_log(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL) {
+        perror(path);
+        return 1;
+    }
+    unsigned char h[LOG_HEADER_SIZE];
+    if (fread(h, 1, sizeof(h), fp) != sizeof(h) || memcmp(h, LOG_MAGIC, 4) != 0 || h[4] != LOG_VERSION) {
+        fprintf(stderr, "%s is not a binary event log\n", path);
+        fclose(fp);
+        return 1;
+    }
+    unsigned char b[LOG_RECORD_SIZE];
+    char line[LOG_LINE_MAX];
+    while (fread(b, 1, sizeof(b), fp) == sizeof(b)) {
+        LogRecord r;
+        decodeLogRecord(b, &r);
+        fwrite(line, 1, formatLogJson(&r, "log", line, sizeof(line)), stdout);
+    }
+    fclose(fp);
     return 0;
 }
+
+void request_stop(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (parse_options(argc, argv)) return 1;
+    if (options.dump_log_path) return dump_log(options.dump_log_path);
+    if (options.grid_rows) return run_grid();
+    if (options.replay_path) {
+        if (openTraceReader(&trace_in, options.replay_path)) {
+            fprintf(stderr, "Cannot read trace %s\n", options.replay_path);
+            return 1;
+        }
+        options.scheduler = trace_in.settings.scheduler;
+        options.adaptive = trace_in.settings.adaptive;
+        options.priority = trace_in.settings.priority;
+    }
+    if (options.record_path) {
+        TraceSettings ts = {options.scheduler, options.adaptive, options.priority};
+        if (openTraceWriter(&trace_out, options.record_path, &ts)) {
+            perror(options.record_path);
+            return 1;
+        }
+    }
+
+    // Initialize queues
+    initIntersection(&junction, GREEN_TIME * 1000);
+    initLaneScheduler(&junction.scheduler, options.scheduler);
+    junction.priority = options.priority;
+    if (options.adaptive) setAdaptiveTiming(&junction, MIN_GREEN_TIME * 1000, MAX_GREEN_TIME * 1000);
+    for (int i = 0; i < NUM_LANES; i++) {
+        initWaitHistogram(&lane_waits[i]);
+    }
+    timeline = createEventQueue();
+    initWaitHistogram(&tick_jitter);
+
+    LogLevel level = options.log_level >= 0 ? (LogLevel)options.log_level : options.fast ? LOG_OFF : LOG_INFO;
+    if (options.log_path == NULL) options.log_path = options.log_format == LOG_FORMAT_BINARY ? LOG_BINARY_PATH : LOG_JSON_PATH;
+    int log_err = openSimLog(&sim_log, options.log_path, "simulator", options.log_format, level);
+    if (log_err == 2) {
+        fprintf(stderr, "%s holds a log in another format, not appending %s records to it\n", options.log_path,
+                options.log_format == LOG_FORMAT_BINARY ? "binary" : "JSON");
+    } else if (log_err) {
+        perror(options.log_path);
+    }
+    SIM_LOG(&sim_log, LOG_INFO, LOG_EV_START, 0, 0, 0, 0, 0);
+
+    if (options.source == SOURCE_SOCKET) {
+        if (openNetServer(&net_server, options.port, NUM_LANES)) return 1;
+        printf("Simulator listening on port %d\n", options.port);
+    } else if (options.source == SOURCE_FILES) {
+        // Load whatever the generator has already written; later reads
+        // start from the recorded offsets
+        initLaneIngest(&lane_ingest, lane_files, NUM_LANES);
+        load_new_vehicles();
+
+        printf("Initial load complete.\n");
+        for (int i = 0; i < NUM_LANES; i++) {
+            printf("Lane %c: %d vehicles\n", 'A' + i, getSize(junction.lanes[i]));
+        }
+    } else if (options.source == SOURCE_SYNTHETIC) {
+        synth_state = options.seed ? options.seed : 1;
+        schedule_synthetic_arrival();
+    }
+
+    // Initial timeline: light starts GREEN, status every 5 seconds
+    schedule_light_change(junction.light_change_at);
+    schedule(EV_STATUS, STATUS_INTERVAL_MS);
+    if (intersectionWaiting(&junction)) wake_dispatch();
+
+    wall_clock_ms(); // start the wall clock
+
+    // Ctrl-C / SIGTERM end the run through the normal cleanup below (so the
+    // shared-memory segment is removed); a second one kills the process
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = request_stop;
+    sa.sa_flags = SA_RESETHAND;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    pthread_t ingest_thread, reporter_thread;
+    int has_ingest = options.source == SOURCE_SOCKET || options.source == SOURCE_FILES;
+    if (!options.fast) {
+        pthread_condattr_t attr;
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&wake_cond, &attr);
+        pthread_condattr_destroy(&attr);
+
+        state_shm = createStateChannel(STATE_SHM_NAME);
+        if (state_shm == NULL) perror("Live state channel unavailable");
+        publish_state();
+
+        arrival_ring = createSpscQueue(ARRIVAL_RING_SIZE);
+        report_ring = createReportQueue(REPORT_RING_SIZE);
+        atomic_store(&threads_running, 1);
+        // Per-vehicle lines are buffered; the reporter flushes once per drain
+        setvbuf(stdout, NULL, _IOFBF, STDOUT_BUFFER);
+        pthread_create(&reporter_thread, NULL, reporter_main, NULL);
+        if (has_ingest) pthread_create(&ingest_thread, NULL, ingest_main, NULL);
+    }
+
+    run_simulation();
+
+    if (!options.fast) {
+        atomic_store(&threads_running, 0);
+        if (has_ingest) {
+            if (options.source == SOURCE_SOCKET) netServerWake(&net_server);
+            pthread_join(ingest_thread, NULL);
+        }
+        pthread_join(reporter_thread, NULL);
+        freeSpscQueue(arrival_ring);
+        freeReportQueue(report_ring);
+        arrival_ring = NULL;
+        report_ring = NULL;
+        if (state_shm) {
+            closeStateChannel(state_shm);
+            removeStateChannel(STATE_SHM_NAME);
+            state_shm = NULL;
+        }
+    }
+    unsigned int wall_ms = wall_clock_ms();
+    print_summary(wall_ms);
+    unsigned long served = 0;
+    for (int i = 0; i < NUM_LANES; i++) served += lane_waits[i].count;
+    if (reports_dropped > 0) SIM_LOG(&sim_log, LOG_WARN, LOG_EV_DROPPED, 0, 0, sim_time_ms, 0, (unsigned int)reports_dropped);
+    SIM_LOG(&sim_log, LOG_INFO, LOG_EV_END, 0, 0, sim_time_ms, 0, (unsigned int)served);
+    closeSimLog(&sim_log);
+    if (trace_out.fp) {
+        TraceRecord end = {TRACE_END, 0, 0, sim_time_ms, 0, (unsigned int)trace_step};
+        traceWrite(&trace_out, &end);
+        printf("Recorded %ld trace records to %s\n", trace_out.records, options.record_path);
+        closeTraceWriter(&trace_out);
+    }
+    int status = 0;
+    if (options.source == SOURCE_REPLAY) {
+        if (!replay_diverged && trace_pos < trace_in.count && traceRecordAt(&trace_in, trace_pos).type != TRACE_END) {
+            fprintf(stderr, "Replay stopped early at record %ld of %ld\n", trace_pos, trace_in.count);
+            replay_diverged = 1;
+        }
+        printf("Replay %s: %ld arrivals, %ld decisions checked in %u ms\n", replay_diverged ? "DIVERGED" : "matched",
+               replay_arrivals, replay_decisions, wall_ms);
+        status = replay_diverged;
+        closeTraceReader(&trace_in);
+    }
+
+    if (options.source == SOURCE_SOCKET && net_server.rejected > 0) {
+        printf("Malformed arrivals rejected: %ld\n", net_server.rejected);
+    }
+
+    // Cleanup
+    freeIntersection(&junction);
+    freeEventQueue(timeline);
+    if (options.source == SOURCE_SOCKET) closeNetServer(&net_server);
+    if (options.source == SOURCE_FILES) closeLaneIngest(&lane_ingest);
+    return status;
+}
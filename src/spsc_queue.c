@@ -0,0 +1,57 @@
+#include "spsc_queue.h"
+#include <stdlib.h>
+#include <stdio.h>
+
+// Vehicle wrapper around SpscRing (spsc_ring.h has the protocol)
+
+// Create a queue holding at least capacity vehicles
+SpscQueue* createSpscQueue(int capacity) {
+    SpscQueue* q = (SpscQueue*)aligned_alloc(CACHE_LINE_SIZE, sizeof(SpscQueue));
+    if (q == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    initSpscRing(&q->ring, capacity, sizeof(Vehicle));
+    return q;
+}
+
+// Producer only: append a vehicle, false if the ring is full
+bool spscEnqueue(SpscQueue* q, Vehicle v) {
+    Vehicle* slot = (Vehicle*)spscRingClaim(&q->ring);
+    if (slot == NULL) return false;
+    *slot = v;
+    spscRingPublish(&q->ring);
+    return true;
+}
+
+// Consumer only: take the front vehicle, false if the ring is empty
+bool spscDequeue(SpscQueue* q, Vehicle* out) {
+    if (spscRingReadable(&q->ring, 1) == 0) return false;
+    *out = *(Vehicle*)spscRingSlot(&q->ring, spscRingHead(&q->ring));
+    spscRingRelease(&q->ring, 1);
+    return true;
+}
+
+// Consumer only: take up to max vehicles with a single head update
+int spscDequeueBatch(SpscQueue* q, Vehicle* out, int max) {
+    unsigned int available = spscRingReadable(&q->ring, (unsigned int)max);
+    int count = available < (unsigned int)max ? (int)available : max;
+    unsigned int head = spscRingHead(&q->ring);
+    for (int i = 0; i < count; i++) {
+        out[i] = *(Vehicle*)spscRingSlot(&q->ring, head + i);
+    }
+    if (count > 0) spscRingRelease(&q->ring, (unsigned int)count);
+    return count;
+}
+
+// Approximate number of queued vehicles (exact when called by either side
+// while the other is idle)
+int spscGetSize(SpscQueue* q) {
+    return spscRingSize(&q->ring);
+}
+
+// Free the queue; neither side may be using it
+void freeSpscQueue(SpscQueue* q) {
+    freeSpscRing(&q->ring);
+    free(q);
+}
@@ -0,0 +1,24 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdbool.h>
+#include "queue.h"
+#include "spsc_ring.h"
+
+// Lock-free single-producer/single-consumer lane queue.
+// One thread may enqueue and one other thread may dequeue concurrently
+// without locks. Capacity is fixed (rounded up to a power of two);
+// enqueue reports false instead of growing when the ring is full.
+typedef struct {
+    SpscRing ring;              // slots hold Vehicles
+} SpscQueue;
+
+// Function prototypes
+SpscQueue* createSpscQueue(int capacity);
+bool spscEnqueue(SpscQueue* q, Vehicle v);
+bool spscDequeue(SpscQueue* q, Vehicle* out);
+int spscDequeueBatch(SpscQueue* q, Vehicle* out, int max);
+int spscGetSize(SpscQueue* q);
+void freeSpscQueue(SpscQueue* q);
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,111 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "cacheline.h"
+
+// Lock-free single-producer/single-consumer ring of fixed-size slots, the
+// one place the handoff protocol lives (SpscQueue, ReportQueue and the
+// event log ring are typed wrappers around it).
+//
+// Lamport-style ring: head and tail are free-running counters, each owned by
+// one side. The owner updates its counter with a release store after touching
+// the slot; the other side reads it with an acquire load. Each side caches the
+// opposite counter and only reloads it when the ring looks full/empty, so in
+// steady state the two cache lines are not bounced on every operation.
+//
+// Slots are filled and read in place: the producer claims a slot, writes it
+// and publishes; the consumer looks at readable slots and releases them.
+typedef struct {
+    // Consumer side: written by the consumer, read by the producer
+    _Alignas(CACHE_LINE_SIZE) atomic_uint head;
+    unsigned int cached_tail;   // consumer's last view of tail
+
+    // Producer side: written by the producer, read by the consumer
+    _Alignas(CACHE_LINE_SIZE) atomic_uint tail;
+    unsigned int cached_head;   // producer's last view of head
+
+    // Shared, read-only after creation
+    _Alignas(CACHE_LINE_SIZE) unsigned char* slots;
+    unsigned int mask;
+    unsigned int slot_size;
+} SpscRing;
+
+// Set up a ring of at least capacity slots (rounded up to a power of two)
+static inline void initSpscRing(SpscRing* r, int capacity, size_t slot_size) {
+    unsigned int count = 2;
+    while (count < (unsigned int)capacity) count <<= 1;
+    r->slots = (unsigned char*)malloc(slot_size * count);
+    if (r->slots == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    r->cached_head = 0;
+    r->cached_tail = 0;
+    r->mask = count - 1;
+    r->slot_size = (unsigned int)slot_size;
+}
+
+// The slot at a free-running position (head + i for the i-th readable one)
+static inline void* spscRingSlot(SpscRing* r, unsigned int pos) {
+    return r->slots + (size_t)(pos & r->mask) * r->slot_size;
+}
+
+// Producer only: the next free slot to fill, NULL if the ring is full
+static inline void* spscRingClaim(SpscRing* r) {
+    unsigned int tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    if (tail - r->cached_head > r->mask) {
+        r->cached_head = atomic_load_explicit(&r->head, memory_order_acquire);
+        if (tail - r->cached_head > r->mask) return NULL;
+    }
+    return spscRingSlot(r, tail);
+}
+
+// Producer only: hand the claimed slot to the consumer
+static inline void spscRingPublish(SpscRing* r) {
+    unsigned int tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+}
+
+// Consumer only: number of slots ready to read; tail is reloaded only when
+// fewer than want are known
+static inline unsigned int spscRingReadable(SpscRing* r, unsigned int want) {
+    unsigned int head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    unsigned int available = r->cached_tail - head;
+    if (available < want) {
+        r->cached_tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+        available = r->cached_tail - head;
+    }
+    return available;
+}
+
+// Consumer only: position of the oldest readable slot
+static inline unsigned int spscRingHead(SpscRing* r) {
+    return atomic_load_explicit(&r->head, memory_order_relaxed);
+}
+
+// Consumer only: give the count oldest slots back to the producer
+static inline void spscRingRelease(SpscRing* r, unsigned int count) {
+    unsigned int head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    atomic_store_explicit(&r->head, head + count, memory_order_release);
+}
+
+// Approximate number of filled slots (exact when called by either side
+// while the other is idle)
+static inline int spscRingSize(SpscRing* r) {
+    unsigned int head = atomic_load_explicit(&r->head, memory_order_acquire);
+    unsigned int tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    return (int)(tail - head);
+}
+
+// Free the slots; neither side may be using the ring
+static inline void freeSpscRing(SpscRing* r) {
+    free(r->slots);
+    r->slots = NULL;
+}
+
+#endif // SPSC_RING_H
@@ -0,0 +1,70 @@
+#include "state_channel.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+void initStateBlock(StateBlock* b) {
+    memset(b, 0, sizeof(*b));
+    b->snap.priority_lane = -1;
+    b->magic = STATE_MAGIC;
+    b->version = STATE_VERSION;
+    atomic_store_explicit(&b->seq, 0, memory_order_release);
+}
+
+// Writer: replace the snapshot (single writer only)
+void publishState(StateBlock* b, const StateSnapshot* s) {
+    unsigned int seq = atomic_load_explicit(&b->seq, memory_order_relaxed);
+    atomic_store_explicit(&b->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&b->snap, s, sizeof(*s));
+    atomic_store_explicit(&b->seq, seq + 2, memory_order_release);
+}
+
+// Reader: copy a consistent snapshot. Returns 0 if the writer kept it busy
+// for STATE_READ_TRIES attempts or the block is not a state block.
+int readState(const StateBlock* b, StateSnapshot* out) {
+    if (b->magic != STATE_MAGIC || b->version != STATE_VERSION) return 0;
+    for (int tries = 0; tries < STATE_READ_TRIES; tries++) {
+        unsigned int before = atomic_load_explicit(&b->seq, memory_order_acquire);
+        if (before & 1) continue;
+        memcpy(out, &b->snap, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&b->seq, memory_order_relaxed) == before) return 1;
+    }
+    return 0;
+}
+
+// Writer: create (or take over) the named segment. Returns NULL on error.
+StateBlock* createStateChannel(const char* name) {
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) return NULL;
+    if (ftruncate(fd, sizeof(StateBlock)) < 0) {
+        close(fd);
+        return NULL;
+    }
+    void* p = mmap(NULL, sizeof(StateBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+    StateBlock* b = (StateBlock*)p;
+    initStateBlock(b);
+    return b;
+}
+
+// Reader: map an existing segment read-only. Returns NULL if there is none.
+const StateBlock* openStateChannel(const char* name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+    void* p = mmap(NULL, sizeof(StateBlock), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return p == MAP_FAILED ? NULL : (const StateBlock*)p;
+}
+
+void closeStateChannel(const StateBlock* b) {
+    if (b) munmap((void*)b, sizeof(StateBlock));
+}
+
+void removeStateChannel(const char* name) {
+    shm_unlink(name);
+}
@@ -0,0 +1,63 @@
+#ifndef STATE_CHANNEL_H
+#define STATE_CHANNEL_H
+
+#include <stdatomic.h>
+#include "cacheline.h"
+
+// Live simulator state in a POSIX shared-memory segment. The simulator is
+// the only writer and republishes after every timeline event; renderers and
+// monitors map the segment read-only and copy out a consistent snapshot at
+// any rate without a single syscall.
+//
+// Consistency comes from a seqlock: the writer makes seq odd, updates the
+// snapshot, then makes it even again. A reader copies the snapshot and
+// retries if seq was odd or changed meanwhile. Readers never block the
+// writer. The block holds no pointers, so every process can map it anywhere.
+
+#define STATE_SHM_NAME "/dsa_traffic_state"
+#define STATE_MAGIC 0x54534154u   // "TATS"
+#define STATE_VERSION 1
+#define STATE_MAX_LANES 4
+#define STATE_RECENT 16           // most recent passes kept
+#define STATE_READ_TRIES 1000
+
+typedef struct {
+    int lane;
+    int from_priority;
+    unsigned int vehicle;
+    unsigned int time_ms;         // when it passed the light
+    unsigned int wait_ms;
+} StateDispatch;
+
+typedef struct {
+    unsigned int time_ms;         // simulation time of the snapshot
+    int light;                    // 1 GREEN, 0 RED
+    unsigned int light_left_ms;
+    int priority_lane;            // -1 when none
+    int queue[STATE_MAX_LANES];   // vehicles waiting
+    unsigned long long served[STATE_MAX_LANES];
+    unsigned int p50_ms[STATE_MAX_LANES];
+    unsigned int p99_ms[STATE_MAX_LANES];
+    unsigned int max_ms[STATE_MAX_LANES];
+    unsigned long long passed;    // vehicles passed so far; the newest is
+                                  // recent[(passed - 1) % STATE_RECENT]
+    StateDispatch recent[STATE_RECENT];
+} StateSnapshot;
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    _Alignas(CACHE_LINE_SIZE) atomic_uint seq;   // odd while an update is in progress
+    StateSnapshot snap;
+} StateBlock;
+
+// Function prototypes
+void initStateBlock(StateBlock* b);
+void publishState(StateBlock* b, const StateSnapshot* s);
+int readState(const StateBlock* b, StateSnapshot* out);
+StateBlock* createStateChannel(const char* name);
+const StateBlock* openStateChannel(const char* name);
+void closeStateChannel(const StateBlock* b);
+void removeStateChannel(const char* name);
+
+#endif // STATE_CHANNEL_H
@@ -0,0 +1,62 @@
+// Live view of a running simulator: maps its shared-memory state channel
+// read-only and prints a snapshot at a fixed rate. Reading never makes a
+// syscall or slows the simulator down.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "state_channel.h"
+
+#define MONITOR_INTERVAL_MS 1000
+
+int main(int argc, char* argv[]) {
+    unsigned int interval_ms = MONITOR_INTERVAL_MS;
+    int count = 0;   // snapshots to print, 0 = keep going
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc) {
+            interval_ms = (unsigned int)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--interval-ms N] [--count N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const StateBlock* state = openStateChannel(STATE_SHM_NAME);
+    if (state == NULL) {
+        fprintf(stderr, "No simulator running (shared memory %s not found)\n", STATE_SHM_NAME);
+        return 1;
+    }
+
+    unsigned long long shown = 0;   // passes already printed
+    for (int n = 0; count == 0 || n < count; n++) {
+        StateSnapshot s;
+        if (!readState(state, &s)) {
+            fprintf(stderr, "Could not read a consistent snapshot\n");
+            break;
+        }
+        printf("[%6.1fs] Light %s (%u sec left)", s.time_ms / 1000.0, s.light ? "GREEN" : "RED",
+               s.light_left_ms / 1000);
+        if (s.priority_lane >= 0) printf(", priority lane %c", 'A' + s.priority_lane);
+        printf("\n");
+        for (int i = 0; i < STATE_MAX_LANES; i++) {
+            printf("  Lane %c: %3d waiting, %llu served, wait p50 %.1fs p99 %.1fs max %.1fs\n", 'A' + i,
+                   s.queue[i], s.served[i], s.p50_ms[i] / 1000.0, s.p99_ms[i] / 1000.0, s.max_ms[i] / 1000.0);
+        }
+        // Passes since the last snapshot, as far as the recent ring reaches
+        unsigned long long from = shown;
+        if (s.passed - from > STATE_RECENT) from = s.passed - STATE_RECENT;
+        for (unsigned long long k = from; k < s.passed; k++) {
+            const StateDispatch* d = &s.recent[k % STATE_RECENT];
+            printf("  passed: vehicle %u from %s %c after %.1fs\n", d->vehicle,
+                   d->from_priority ? "priority lane" : "lane", 'A' + d->lane, d->wait_ms / 1000.0);
+        }
+        shown = s.passed;
+        fflush(stdout);
+        usleep(interval_ms * 1000);
+    }
+
+    closeStateChannel(state);
+    return 0;
+}
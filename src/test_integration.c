@@ -1,7 +1,20 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "queue.h"
+#include "wait_stats.h"
+#include "event_queue.h"
+#include "lane_ingest.h"
+#include "lane_writer.h"
+#include "wire.h"
+#include "grid.h"
+#include "arrivals.h"
+#include "sim_trace.h"
+#include "state_channel.h"
+#include "sim_log.h"
 
 void test_integration() {
     printf("Running integration tests...\n");
@@ -9,7 +22,7 @@ void test_integration() {
     // Test queue operations
     Queue* q = createQueue();
     for (int i = 1; i <= 10; i++) {
-        Vehicle v = {i};
+        Vehicle v = {.id = i};
         enqueue(q, v);
     }
     assert(getSize(q) == 10);
@@ -24,7 +37,663 @@ void test_integration() {
     printf("Integration tests passed!\n");
 }
 
+void test_wait_histogram() {
+    assert(sizeof(Vehicle) == 16);
+
+    static WaitHistogram h;
+    initWaitHistogram(&h);
+    assert(waitPercentile(&h, 0.5) == 0);
+
+    // Vehicles waiting 1..1000 seconds, one each
+    Queue* q = createQueue();
+    for (int i = 1; i <= 1000; i++) {
+        Vehicle v = {.id = i};
+        v.arrival_ms = 0;
+        enqueue(q, v);
+    }
+    for (int i = 1; i <= 1000; i++) {
+        Vehicle v = dequeue(q);
+        v.departure_ms = (unsigned int)v.id * 1000;
+        recordDeparture(&h, &v);
+    }
+    freeQueue(q);
+
+    assert(h.count == 1000);
+    assert(h.max_ms == 1000000);
+    unsigned int p50 = waitPercentile(&h, 0.50);
+    unsigned int p99 = waitPercentile(&h, 0.99);
+    assert(p50 >= 500000 && p50 <= 500000 * 1.04);
+    assert(p99 >= 990000 && p99 <= 1000000);
+    assert(waitPercentile(&h, 1.0) == 1000000);
+    assert(waitMean(&h) == 500500.0);
+
+    // Small waits are exact
+    initWaitHistogram(&h);
+    recordWait(&h, 7);
+    assert(waitPercentile(&h, 0.5) == 7);
+
+    printf("Wait histogram tests passed!\n");
+}
+
+void test_event_timeline() {
+    EventQueue* eq = createEventQueue();
+    // Shuffled timestamps, plus same-time events of different types
+    unsigned int times[] = {5000, 1000, 3000, 1000, 2000, 4000, 1000};
+    EventType types[] = {EV_STATUS, EV_DEPARTURE, EV_ARRIVAL, EV_ARRIVAL, EV_STATUS, EV_LIGHT_CHANGE, EV_LIGHT_CHANGE};
+    for (int i = 0; i < 7; i++) {
+        SimEvent ev = {.time_ms = times[i], .type = types[i]};
+        pushEvent(eq, ev);
+    }
+    for (int i = 0; i < 200; i++) { // force growth
+        SimEvent ev = {.time_ms = 10000 + (unsigned int)(i * 37 % 200), .type = EV_ARRIVAL};
+        pushEvent(eq, ev);
+    }
+
+    SimEvent ev = popEvent(eq);
+    assert(ev.time_ms == 1000 && ev.type == EV_LIGHT_CHANGE);
+    ev = popEvent(eq);
+    assert(ev.time_ms == 1000 && ev.type == EV_ARRIVAL);
+    ev = popEvent(eq);
+    assert(ev.time_ms == 1000 && ev.type == EV_DEPARTURE);
+    unsigned int last = ev.time_ms;
+    int popped = 3;
+    while (!isEventQueueEmpty(eq)) {
+        ev = popEvent(eq);
+        assert(ev.time_ms >= last);
+        last = ev.time_ms;
+        popped++;
+    }
+    assert(popped == 207);
+
+    freeEventQueue(eq);
+    printf("Event timeline tests passed!\n");
+}
+
+static int ingested_ids[INGEST_COMPACT_BYTES / 4];
+static int ingested = 0;
+
+static void collect_line(int lane, const char* line, void* ctx) {
+    (void)lane;
+    (void)ctx;
+    ingested_ids[ingested++] = atoi(line);
+}
+
+static void append_text(const char* path, const char* text) {
+    FILE* fp = fopen(path, "a");
+    fputs(text, fp);
+    fclose(fp);
+}
+
+void test_lane_ingest() {
+    const char* paths[1] = {"/tmp/dsa_test_lane.txt"};
+    FILE* fp = fopen(paths[0], "w");
+    fputs("1\n2\n", fp);
+    fclose(fp);
+
+    LaneIngest in;
+    initLaneIngest(&in, paths, 1);
+    assert(ingestLane(&in, 0, collect_line, NULL) == 2);
+    assert(ingestLane(&in, 0, collect_line, NULL) == 0); // nothing new
+
+    // A partial line is held back until its newline arrives
+    append_text(paths[0], "3\n4");
+    assert(ingestLane(&in, 0, collect_line, NULL) == 1);
+    append_text(paths[0], "5\n6\n");
+    assert(ingestLane(&in, 0, collect_line, NULL) == 2);
+
+    // A truncated file is read again from the start
+    fp = fopen(paths[0], "w");
+    fputs("7\n", fp);
+    fclose(fp);
+    assert(ingestLane(&in, 0, collect_line, NULL) == 1);
+
+    int expected[] = {1, 2, 3, 45, 6, 7};
+    assert(ingested == 6);
+    for (int i = 0; i < 6; i++) assert(ingested_ids[i] == expected[i]);
+
+    // Once consumed past the compaction threshold the file is emptied
+    fp = fopen(paths[0], "a");
+    for (int i = 0; i < INGEST_COMPACT_BYTES / 8; i++) fputs("0000000\n", fp);
+    fclose(fp);
+    ingested = 0;
+    assert(ingestLane(&in, 0, collect_line, NULL) == INGEST_COMPACT_BYTES / 8);
+    fp = fopen(paths[0], "r");
+    fseek(fp, 0, SEEK_END);
+    assert(ftell(fp) == 0);
+    fclose(fp);
+
+    closeLaneIngest(&in);
+    remove(paths[0]);
+    printf("Lane ingest tests passed!\n");
+}
+
+// LaneWriter feeding LaneIngest: nothing is seen before a flush, every id
+// afterwards, and appends keep working across the reader's compaction
+void test_lane_writer() {
+    const char* paths[1] = {"/tmp/dsa_test_writer.txt"};
+    LaneWriter w;
+    assert(openLaneWriter(&w, paths, 1, 1, 100) == 0);
+    LaneIngest in;
+    initLaneIngest(&in, paths, 1);
+    ingested = 0;
+
+    assert(laneWriterAppend(&w, 0, 0) == 0 && laneWriterAppend(&w, 0, 4294967295u) == 0);
+    assert(ingestLane(&in, 0, collect_line, NULL) == 0 && w.writes == 0);
+    assert(laneWriterFlushDue(&w, 10, 50) == 0);      // can still wait
+    assert(laneWriterFlushDue(&w, 50, 150) == 0 && w.writes == 1);
+    assert(ingestLane(&in, 0, collect_line, NULL) == 2 && ingested_ids[0] == 0);
+
+    // Enough lines to fill the buffer several times and trip compaction
+    int count = INGEST_COMPACT_BYTES / 6;
+    ingested = 0;
+    for (int i = 0; i < count; i++) assert(laneWriterAppend(&w, 0, 10000 + i) == 0);
+    assert(w.writes >= 1 + count * 6 / LANE_WRITE_BUFFER);
+    flushLaneWriter(&w);
+    assert(ingestLane(&in, 0, collect_line, NULL) == count);
+    assert(laneWriterAppend(&w, 0, 77) == 0 && flushLaneWriter(&w) == 0);
+    assert(ingestLane(&in, 0, collect_line, NULL) == 1 && ingested_ids[count] == 77);
+    for (int i = 0; i < count; i++) assert(ingested_ids[i] == 10000 + i);
+
+    // Unbuffered: every append is its own write
+    closeLaneWriter(&w);
+    assert(openLaneWriter(&w, paths, 1, 0, 0) == 0);
+    long before = w.writes;
+    laneWriterAppend(&w, 0, 5);
+    assert(w.writes == before + 1 && ingestLane(&in, 0, collect_line, NULL) == 1);
+    closeLaneWriter(&w);
+    closeLaneIngest(&in);
+    remove(paths[0]);
+    printf("Lane writer tests passed!\n");
+}
+
+void test_wire_protocol() {
+    WireArrival in[3] = {{7, 0, INTENT_STRAIGHT}, {0xFFFFFFFFu, 3, INTENT_LEFT}, {9, 2, INTENT_RIGHT}};
+    unsigned char frame[WIRE_MAX_FRAME];
+    int len = wireEncodeFrame(frame, in, 3);
+    assert(len == WIRE_HEADER_SIZE + 3 * WIRE_ARRIVAL_SIZE);
+
+    // Incomplete frames consume nothing
+    WireArrival out[WIRE_MAX_BATCH];
+    int consumed;
+    assert(wireDecodeFrame(frame, WIRE_HEADER_SIZE - 1, out, &consumed) == 0 && consumed == 0);
+    assert(wireDecodeFrame(frame, len - 1, out, &consumed) == 0 && consumed == 0);
+
+    assert(wireDecodeFrame(frame, len, out, &consumed) == 3 && consumed == len);
+    for (int i = 0; i < 3; i++) {
+        assert(out[i].id == in[i].id && out[i].lane == in[i].lane && out[i].intent == in[i].intent);
+    }
+
+    // Unknown versions are rejected rather than misparsed
+    frame[1] = WIRE_VERSION + 1;
+    assert(wireDecodeFrame(frame, len, out, &consumed) == -1);
+
+    // Text lines round-trip and bad lanes are refused
+    char line[64];
+    wireFormatText(line, sizeof(line), &in[2]);
+    line[strlen(line) - 1] = '\0';
+    assert(wireParseText(line, 4, &out[0]) && out[0].id == 9 && out[0].lane == 2 && out[0].intent == INTENT_RIGHT);
+    assert(!wireParseText("Vehicle 3 to lane E", 4, &out[0]));
+    printf("Wire protocol tests passed!\n");
+}
+
+void test_grid() {
+    // Same grid on one band and on three: identical results, nothing lost
+    GridStats runs[2];
+    int shards[2] = {1, 3};
+    for (int r = 0; r < 2; r++) {
+        Grid* g = createGrid(6, 5, shards[r], 300);
+        assert(g->shard_count == shards[r]);
+        runGrid(g, 100 * 1000);
+        runGrid(g, 100 * 1000); // resumes where it stopped
+        assert(g->now_ms == 200 * 1000);
+        getGridStats(g, &runs[r]);
+        assert(runs[r].spawned > 0 && runs[r].exited > 0);
+        assert(runs[r].spawned == runs[r].exited + runs[r].queued);
+        assert(runs[r].intersection_ticks == 6 * 5 * 200);
+        freeGrid(g);
+    }
+    assert(runs[0].spawned == runs[1].spawned && runs[0].exited == runs[1].exited);
+    assert(runs[0].waits.count == runs[1].waits.count && runs[0].waits.total_ms == runs[1].waits.total_ms);
+
+    // Traffic is routed to the neighbour the vehicle ends up heading for
+    assert(laneForHeading(DIR_SOUTH) == 0 && laneForHeading(DIR_EAST) == 3);
+    for (int l = 0; l < NUM_LANES; l++) assert(laneForHeading(lane_directions[l]) == l);
+    printf("Grid tests passed!\n");
+}
+
+static int plan(LaneScheduler* s, int a, int b, int c, int d, int take[NUM_LANES]) {
+    int lengths[NUM_LANES] = {a, b, c, d};
+    for (int l = 0; l < NUM_LANES; l++) take[l] = 0;
+    return s->plan(s, lengths, 4, take);
+}
+
+void test_schedulers() {
+    LaneScheduler s;
+    int take[NUM_LANES];
+
+    // Round-robin stub: aims for total/n but never sends more than one per lane
+    initLaneScheduler(&s, SCHED_ROUND_ROBIN);
+    assert(plan(&s, 20, 0, 0, 8, take) == 7);
+    assert(take[0] == 1 && take[1] == 0 && take[3] == 1);
+
+    // Proportional: total/n vehicles, split by weighted length
+    initLaneScheduler(&s, schedulerKindFromName("proportional"));
+    assert(plan(&s, 8, 4, 0, 0, take) == 3);
+    assert(take[0] == 2 && take[1] == 1);
+    s.weights[1] = 4;
+    assert(plan(&s, 8, 4, 0, 0, take) == 3);
+    assert(take[0] == 1 && take[1] == 2);
+    assert(plan(&s, 1, 0, 0, 0, take) == 1 && take[0] == 1);
+    assert(plan(&s, 0, 0, 0, 0, take) == 0);
+
+    // DRR: quanta 2,1,1,1; a full slot resumes mid-round next time
+    initLaneScheduler(&s, SCHED_DRR);
+    s.weights[0] = 2;
+    assert(plan(&s, 9, 9, 9, 9, take) == 4);
+    assert(take[0] == 2 && take[1] == 1 && take[2] == 1 && take[3] == 0);
+    assert(plan(&s, 7, 8, 8, 9, take) == 4);
+    assert(take[3] == 1 && take[0] == 2 && take[1] == 1);
+    // Work-conserving: a lone busy lane gets the whole slot
+    assert(plan(&s, 0, 0, 6, 0, take) == 4 && take[2] == 4);
+    s.weights[0] = s.weights[1] = s.weights[2] = s.weights[3] = 0;
+    assert(plan(&s, 5, 5, 5, 5, take) == 0); // zero quanta must not spin
+
+    // Max-pressure: longest queue first
+    initLaneScheduler(&s, SCHED_MAX_PRESSURE);
+    assert(plan(&s, 8, 6, 0, 1, take) == 4);
+    assert(take[0] == 3 && take[1] == 1);
+
+    assert(schedulerKindFromName("fifo") == -1);
+    assert(strcmp(schedulerName(SCHED_DRR), "drr") == 0);
+
+    // Priority rule: lane A above 10 is served alone, per_slot at a time
+    Intersection ix;
+    initIntersection(&ix, GREEN_TIME * 1000);
+    ix.priority.per_slot = 2;
+    for (int i = 0; i < 11; i++) {
+        Vehicle v = {.id = i, .lane = 0};
+        enqueue(ix.lanes[0], v);
+    }
+    Vehicle b = {.id = 100, .lane = 1};
+    enqueue(ix.lanes[1], b);
+    Vehicle out[DISPATCH_CAPACITY];
+    DispatchResult d = dispatchIntersection(&ix, 1000, out);
+    assert(d.priority_on && d.from_priority && d.passed == 2 && out[0].id == 0 && out[1].departure_ms == 1000);
+    for (int slot = 0; slot < 3; slot++) d = dispatchIntersection(&ix, 2000, out);
+    assert(d.priority_off && getSize(ix.lanes[0]) == 3 && getSize(ix.lanes[1]) == 1);
+    d = dispatchIntersection(&ix, 3000, out);
+    assert(!d.from_priority && d.passed == 1);
+    freeIntersection(&ix);
+    printf("Scheduler tests passed!\n");
+}
+
+void test_adaptive_timing() {
+    Intersection ix;
+    initIntersection(&ix, 10 * 1000);
+    initLaneScheduler(&ix.scheduler, SCHED_DRR);
+    setAdaptiveTiming(&ix, 3000, 30000);
+
+    // Nobody waiting when RED ends: the light rests until a vehicle shows up
+    assert(changeLight(&ix, 10000) == RED && ix.light_change_at == 15000);
+    assert(changeLight(&ix, 15000) == RED && ix.phase.resting);
+    assert(demandGreen(&ix, 17000) == 1 && ix.light_change_at == 17000);
+    assert(demandGreen(&ix, 17000) == 0);
+
+    // 12 waiting at the initial 2 vehicles/s: 6 slots plus one for the last
+    for (int i = 0; i < 12; i++) {
+        Vehicle v = {.id = i, .lane = (unsigned char)(i % NUM_LANES)};
+        enqueue(ix.lanes[v.lane], v);
+    }
+    assert(changeLight(&ix, 17000) == GREEN && ix.light_change_at == 24000);
+    Vehicle out[DISPATCH_CAPACITY];
+    unsigned int now = 17000;
+    for (; intersectionWaiting(&ix); now += 1000) {
+        assert(gapOut(&ix, now) == 0);
+        dispatchIntersection(&ix, now, out);
+    }
+    // Drained in 3 slots; green ends GAP_TIME after the last busy one
+    assert(now == 20000);
+    assert(gapOut(&ix, now) == 1 && ix.light_change_at == 19000 + GAP_TIME * 1000);
+    assert(gapOut(&ix, now) == 0);
+
+    // 12 vehicles in 3 busy slots pulls the rate from 2/s towards 4/s
+    assert(changeLight(&ix, 22000) == RED);
+    assert(ix.phase.discharge_rate == 2.5);
+
+    // A long queue is capped at the maximum, and extended no further
+    for (int i = 0; i < 200; i++) {
+        Vehicle v = {.id = i, .lane = 1};
+        enqueue(ix.lanes[1], v);
+    }
+    assert(changeLight(&ix, 27000) == GREEN && ix.light_change_at == 57000);
+    assert(changeLight(&ix, 40000) == GREEN && ix.light_change_at == 57000);
+    assert(changeLight(&ix, 57000) == RED);
+    freeIntersection(&ix);
+
+    // Fixed timing ignores the queues
+    initIntersection(&ix, 10 * 1000);
+    assert(changeLight(&ix, 10000) == RED && changeLight(&ix, 15000) == GREEN);
+    assert(ix.light_change_at == 15000 + GREEN_TIME * 1000 && gapOut(&ix, 16000) == 0);
+    freeIntersection(&ix);
+    printf("Adaptive timing tests passed!\n");
+}
+
+// Arrivals per 10 s window over an hour, and their variance / mean
+static double dispersion(ArrivalGen* g, long* total) {
+    WireArrival batch[WIRE_MAX_BATCH];
+    double sum = 0, sq = 0;
+    for (unsigned int w = 1; w <= 360; w++) {
+        int count = 0, n;
+        while ((n = takeArrivals(g, w * 10000, batch, WIRE_MAX_BATCH)) > 0) count += n;
+        sum += count;
+        sq += (double)count * count;
+    }
+    *total = (long)sum;
+    double mean = sum / 360;
+    return (sq / 360 - mean * mean) / mean;
+}
+
+void test_arrival_models() {
+    ArrivalConfig cfg;
+    ArrivalGen a, b;
+    WireArrival x[64], y[64];
+
+    // Same seed, same arrivals; another seed, different ones
+    defaultArrivalConfig(&cfg, ARRIVAL_POISSON, 0.5);
+    initArrivalGen(&a, &cfg, 7, 1);
+    initArrivalGen(&b, &cfg, 7, 1);
+    assert(takeArrivals(&a, 1000000, x, 64) == 64 && takeArrivals(&b, 1000000, y, 64) == 64);
+    assert(memcmp(x, y, sizeof(x)) == 0);
+    for (int i = 1; i < 64; i++) assert(x[i].id == x[i - 1].id + 1);
+    initArrivalGen(&b, &cfg, 8, 1);
+    takeArrivals(&b, 1000000, y, 64);
+    assert(memcmp(x, y, sizeof(x)) != 0);
+
+    // peek does not consume; take stops at the deadline; times never go back
+    unsigned int at, last = 0;
+    for (int i = 0; i < 64; i++) {
+        assert(peekArrival(&a, &at) && peekArrival(&a, &at) && at >= last);
+        assert(takeArrivals(&a, at, x, 1) == 0 && takeArrivals(&a, at + 1, x, 1) == 1);
+        last = at;
+    }
+
+    // Poisson: 1.5 arrivals/s over an hour, counts per window about as
+    // variable as their mean; an idle lane never gets any
+    cfg.rate[3] = 0;
+    initArrivalGen(&a, &cfg, 1, 1);
+    long total;
+    double d = dispersion(&a, &total);
+    assert(total > 1.5 * 3600 * 0.95 && total < 1.5 * 3600 * 1.05);
+    assert(d > 0.7 && d < 1.3);
+    initArrivalGen(&a, &cfg, 1, 1);
+    for (int n; (n = takeArrivals(&a, 600000, x, 64)) > 0;) {
+        for (int i = 0; i < n; i++) assert(x[i].lane != 3);
+    }
+
+    // MMPP: the same calm rate but bursty, so windows vary far more
+    defaultArrivalConfig(&cfg, ARRIVAL_MMPP, 0.5);
+    initArrivalGen(&a, &cfg, 1, 1);
+    d = dispersion(&a, &total);
+    assert(total > 2 * 3600 && d > 3.0);
+
+    // Diurnal: a day squeezed into 240 s keeps the mean rate but the
+    // morning peak is far busier than the night
+    defaultArrivalConfig(&cfg, ARRIVAL_DIURNAL, 1.0);
+    cfg.day_s = 240;
+    initArrivalGen(&a, &cfg, 1, 1);
+    int per_hour[DIURNAL_POINTS] = {0};
+    long day_total = 0;
+    for (int day = 0; day < 20; day++) {
+        for (int h = 0; h < DIURNAL_POINTS; h++) {
+            int n;
+            while ((n = takeArrivals(&a, (day * DIURNAL_POINTS + h + 1) * 10000, x, 64)) > 0) {
+                per_hour[h] += n;
+                day_total += n;
+            }
+        }
+    }
+    assert(day_total > 4 * 4800 * 0.95 && day_total < 4 * 4800 * 1.05);
+    assert(per_hour[8] > 10 * per_hour[3]);
+
+    // Trace: replays offsets and lanes exactly, then ends
+    TimedArrival trace[3] = {{500, {0, 2, 0}}, {500, {0, 0, 0}}, {2500, {0, 1, 0}}};
+    defaultArrivalConfig(&cfg, ARRIVAL_TRACE, 0);
+    cfg.trace = trace;
+    cfg.trace_len = 3;
+    initArrivalGen(&a, &cfg, 1, 100);
+    assert(takeArrivals(&a, 1000, x, 64) == 2 && x[0].lane == 2 && x[1].id == 101);
+    assert(peekArrival(&a, &at) && at == 2500 && takeArrivals(&a, 100000, x, 64) == 1 && x[0].lane == 1);
+    assert(!peekArrival(&a, &at));
+
+    assert(arrivalModelFromName("mmpp") == ARRIVAL_MMPP && arrivalModelFromName("uniform") == -1);
+    printf("Arrival model tests passed!\n");
+}
+
+void test_sim_trace() {
+    const char* path = "/tmp/test_sim_trace.trc";
+    TraceSettings ts = {SCHED_DRR, 1, {2, 8, 3, 2}};
+    TraceWriter w;
+    assert(openTraceWriter(&w, path, &ts) == 0);
+    for (unsigned int i = 0; i < 1000; i++) {
+        TraceRecord r = {(unsigned char)(i % 2 ? TRACE_PASS : TRACE_ARRIVAL), (unsigned char)(i % NUM_LANES), 1,
+                         i * 1000, 70000 + i, i / 2};
+        traceWrite(&w, &r);
+    }
+    closeTraceWriter(&w);
+
+    // Read back through the mapping: settings and every record intact
+    TraceReader r;
+    assert(openTraceReader(&r, path) == 0);
+    assert(r.count == 1000 && r.settings.scheduler == SCHED_DRR && r.settings.adaptive == 1);
+    assert(r.settings.priority.lane == 2 && r.settings.priority.enter_above == 8 &&
+           r.settings.priority.leave_below == 3 && r.settings.priority.per_slot == 2);
+    TraceRecord rec = traceRecordAt(&r, 999);
+    assert(rec.type == TRACE_PASS && rec.lane == 3 && rec.value == 1);
+    assert(rec.time_ms == 999000 && rec.id == 70999 && rec.aux == 499);
+    closeTraceReader(&r);
+
+    // A torn record or a foreign file is refused
+    FILE* fp = fopen(path, "ab");
+    fputc(0, fp);
+    fclose(fp);
+    assert(openTraceReader(&r, path) == 1);
+    fp = fopen(path, "wb");
+    for (int i = 0; i < TRACE_HEADER_SIZE; i++) fputc('x', fp);
+    fclose(fp);
+    assert(openTraceReader(&r, path) == 1);
+    assert(openTraceReader(&r, "/tmp/no_such_trace.trc") == 1);
+    remove(path);
+    printf("Trace record tests passed!\n");
+}
+
+// Receiver counting: the vector scan agrees with a byte loop at every
+// alignment, and countLane() follows appends, a cold start and truncation
+void test_lane_counts() {
+    static char buf[5000];
+    for (int i = 0; i < (int)sizeof(buf); i++) buf[i] = (i * 7919) % 13 == 0 ? '\n' : 'x';
+    for (int start = 0; start < 17; start++) {
+        for (int len = 0; len + start <= (int)sizeof(buf); len += 97) {
+            long want = 0;
+            for (int i = start; i < start + len; i++) want += buf[i] == '\n';
+            assert(countNewlines(buf + start, len) == want);
+        }
+    }
+
+    const char* paths[1] = {"/tmp/dsa_test_count.txt"};
+    LaneWriter w;
+    assert(openLaneWriter(&w, paths, 1, 1, 0) == 0);
+    LaneIngest in;
+    initLaneIngest(&in, paths, 1);
+    assert(countLane(&in, 0) == 0);
+    laneWriterAppend(&w, 0, 1);
+    laneWriterAppend(&w, 0, 2);
+    assert(countChanged(&in) == 1 && in.lanes[0].lines == 2);
+    assert(countChanged(&in) == 0);
+
+    // Big enough to be mapped on a cold start; a fresh counter agrees
+    int count = COUNT_MMAP_BYTES / 4;
+    for (int i = 0; i < count; i++) laneWriterAppend(&w, 0, 100000 + i);
+    assert(countLane(&in, 0) == count + 2);
+    LaneIngest cold;
+    initLaneIngest(&cold, paths, 1);
+    assert(countLane(&cold, 0) == count + 2);
+    closeLaneIngest(&cold);
+
+    // Truncation (the simulator compacting) starts the count again
+    closeLaneWriter(&w);
+    assert(openLaneWriter(&w, paths, 1, 1, 0) == 0);
+    laneWriterAppend(&w, 0, 3);
+    assert(countLane(&in, 0) == 1);
+    closeLaneWriter(&w);
+    closeLaneIngest(&in);
+    remove(paths[0]);
+    printf("Lane count tests passed!\n");
+}
+
+// Event log: JSON formatting, level filtering, and binary records coming
+// back in order through the ring and the writer thread
+void test_sim_log() {
+    LogRecord r = {LOG_DEBUG, LOG_EV_PASS, 2, 1, 1500, 42, 300};
+    char line[LOG_LINE_MAX];
+    int len = formatLogJson(&r, "test", line, sizeof(line));
+    assert(strcmp(line, "{\"t_ms\":1500,\"src\":\"test\",\"level\":\"debug\",\"event\":\"pass\","
+                        "\"lane\":\"C\",\"id\":42,\"priority\":true,\"wait_ms\":300}\n") == 0);
+    assert(len == (int)strlen(line));
+    assert(logLevelFromName("warn") == LOG_WARN && logLevelFromName("loud") < 0);
+    assert(logFormatFromName("binary") == LOG_FORMAT_BINARY);
+
+    // A logger that was never opened (or is off) takes nothing
+    SimLog off;
+    assert(openSimLog(&off, "/tmp/dsa_test_off.log", "test", LOG_FORMAT_JSON, LOG_OFF) == 0);
+    assert(!logEnabled(&off, LOG_ERROR));
+    closeSimLog(&off);
+
+    const char* path = "/tmp/dsa_test_log.bin";
+    remove(path);
+    SimLog lg;
+    assert(openSimLog(&lg, path, "test", LOG_FORMAT_BINARY, LOG_INFO) == 0);
+    int count = LOG_RING_SIZE * 3;
+    for (int i = 0; i < count; i++) {
+        SIM_LOG(&lg, LOG_INFO, LOG_EV_QUEUE, i % 4, 0, (unsigned int)i, 0, (unsigned int)i);
+        SIM_LOG(&lg, LOG_DEBUG, LOG_EV_ARRIVAL, 0, 0, (unsigned int)i, 0, 0);   // filtered out
+        if (i % 1000 == 999) usleep(LOG_IDLE_US);   // let the writer keep up
+    }
+    long dropped = lg.dropped;
+    closeSimLog(&lg);
+
+    FILE* fp = fopen(path, "rb");
+    assert(fp != NULL);
+    unsigned char h[LOG_HEADER_SIZE], b[LOG_RECORD_SIZE];
+    assert(fread(h, 1, sizeof(h), fp) == sizeof(h) && memcmp(h, LOG_MAGIC, 4) == 0);
+    long read = 0;
+    unsigned int last = 0;
+    while (fread(b, 1, sizeof(b), fp) == sizeof(b)) {
+        decodeLogRecord(b, &r);
+        if (r.event == LOG_EV_DROPPED) {
+            assert((long)r.value == dropped);
+            continue;
+        }
+        assert(r.event == LOG_EV_QUEUE && r.lane == r.value % 4 && r.time_ms == r.value);
+        assert(read == 0 || r.value > last);
+        last = r.value;
+        read++;
+    }
+    fclose(fp);
+    assert(read + dropped == count);
+
+    // Neither format is appended to a file written in the other
+    assert(openSimLog(&lg, path, "test", LOG_FORMAT_JSON, LOG_INFO) == 2);
+    remove(path);
+    fp = fopen(path, "w");
+    fputs("{\"t_ms\":0}\n", fp);
+    fclose(fp);
+    assert(openSimLog(&lg, path, "test", LOG_FORMAT_BINARY, LOG_INFO) == 2);
+    assert(openSimLog(&lg, path, "test", LOG_FORMAT_JSON, LOG_INFO) == 0);
+    closeSimLog(&lg);
+    remove(path);
+    printf("Event log tests passed! (%ld records, %ld dropped)\n", read, dropped);
+}
+
+// Writer thread for the seqlock test: every field of snapshot n holds n
+#define STATE_TEST_ROUNDS 200000
+void* state_writer(void* arg) {
+    StateBlock* b = (StateBlock*)arg;
+    StateSnapshot s;
+    for (unsigned int n = 1; n <= STATE_TEST_ROUNDS; n++) {
+        s.time_ms = n;
+        s.light_left_ms = n;
+        for (int i = 0; i < STATE_MAX_LANES; i++) s.queue[i] = (int)n;
+        s.passed = n;
+        for (int k = 0; k < STATE_RECENT; k++) s.recent[k].vehicle = n;
+        publishState(b, &s);
+    }
+    return NULL;
+}
+
+// State channel: shared-memory roundtrip, an update in progress is never
+// read, and a reader racing the writer only ever sees whole snapshots
+void test_state_channel() {
+    const char* name = "/dsa_test_state";
+    StateBlock* w = createStateChannel(name);
+    assert(w != NULL);
+    const StateBlock* r = openStateChannel(name);
+    assert(r != NULL);
+    StateSnapshot s, got;
+    memset(&s, 0, sizeof(s));
+    s.time_ms = 1234;
+    s.light = 1;
+    s.priority_lane = 0;
+    s.queue[2] = 11;
+    s.passed = 1;
+    s.recent[0].vehicle = 42;
+    publishState(w, &s);
+    assert(readState(r, &got) == 1);
+    assert(got.time_ms == 1234 && got.light == 1 && got.queue[2] == 11 && got.recent[0].vehicle == 42);
+
+    atomic_fetch_add(&w->seq, 1);   // writer "stuck" mid-update
+    assert(readState(r, &got) == 0);
+    atomic_fetch_add(&w->seq, 1);
+    closeStateChannel(r);
+    closeStateChannel(w);
+    removeStateChannel(name);
+    assert(openStateChannel(name) == NULL);
+
+    StateBlock* b = malloc(sizeof(StateBlock));
+    assert(b != NULL);
+    initStateBlock(b);
+    pthread_t writer;
+    pthread_create(&writer, NULL, state_writer, b);
+    unsigned int last = 0;
+    long reads = 0;
+    while (last < STATE_TEST_ROUNDS) {
+        if (!readState(b, &got)) continue;
+        unsigned int n = got.time_ms;
+        assert(n >= last);
+        assert(got.light_left_ms == n && got.passed == n);
+        for (int i = 0; i < STATE_MAX_LANES; i++) assert(got.queue[i] == (int)n);
+        for (int k = 0; k < STATE_RECENT; k++) assert(got.recent[k].vehicle == n);
+        last = n;
+        reads++;
+    }
+    pthread_join(writer, NULL);
+    free(b);
+    printf("State channel tests passed! (%ld consistent reads)\n", reads);
+}
+
 int main() {
     test_integration();
+    test_wait_histogram();
+    test_event_timeline();
+    test_lane_ingest();
+    test_lane_writer();
+    test_lane_counts();
+    test_wire_protocol();
+    test_grid();
+    test_schedulers();
+    test_adaptive_timing();
+    test_arrival_models();
+    test_sim_trace();
+    test_state_channel();
+    test_sim_log();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include "mpmc_queue.h"
+
+#define PRODUCERS 4
+#define CONSUMERS 2
+#define PER_PRODUCER 500000
+#define TOTAL (PRODUCERS * PER_PRODUCER)
+
+static MpmcQueue* shared_q;
+static unsigned char seen[TOTAL];
+static atomic_int consumed;
+
+void test_mpmc_basic() {
+    MpmcQueue* q = createMpmcQueue(4);
+    Vehicle v;
+    assert(!mpmcDequeue(q, &v));
+    for (int i = 0; i < 4; i++) {
+        Vehicle in = {.id = i};
+        assert(mpmcEnqueue(q, in));
+    }
+    Vehicle extra = {.id = 99};
+    assert(!mpmcEnqueue(q, extra));
+    assert(mpmcGetSize(q) == 4);
+    for (int i = 0; i < 4; i++) {
+        assert(mpmcDequeue(q, &v) && v.id == i);
+    }
+    assert(!mpmcDequeue(q, &v));
+    freeMpmcQueue(q);
+    printf("MPMC basic tests passed!\n");
+}
+
+static void* producer(void* arg) {
+    int base = (int)(long)arg * PER_PRODUCER;
+    for (int i = 0; i < PER_PRODUCER; i++) {
+        Vehicle v = {.id = base + i};
+        while (!mpmcEnqueue(shared_q, v)) sched_yield();
+    }
+    return NULL;
+}
+
+static void* consumer(void* arg) {
+    (void)arg;
+    // Each producer's vehicles must reach any one consumer in order
+    int last[PRODUCERS];
+    for (int p = 0; p < PRODUCERS; p++) last[p] = -1;
+    while (atomic_load(&consumed) < TOTAL) {
+        Vehicle v;
+        if (!mpmcDequeue(shared_q, &v)) {
+            sched_yield();
+            continue;
+        }
+        int p = v.id / PER_PRODUCER;
+        assert(v.id > last[p]);
+        last[p] = v.id;
+        assert(seen[v.id] == 0);
+        seen[v.id] = 1;
+        atomic_fetch_add(&consumed, 1);
+    }
+    return NULL;
+}
+
+void test_mpmc_stress() {
+    shared_q = createMpmcQueue(128);
+    pthread_t producers[PRODUCERS], consumers[CONSUMERS];
+    for (int c = 0; c < CONSUMERS; c++) pthread_create(&consumers[c], NULL, consumer, NULL);
+    for (long p = 0; p < PRODUCERS; p++) pthread_create(&producers[p], NULL, producer, (void*)p);
+    for (int p = 0; p < PRODUCERS; p++) pthread_join(producers[p], NULL);
+    for (int c = 0; c < CONSUMERS; c++) pthread_join(consumers[c], NULL);
+
+    for (int i = 0; i < TOTAL; i++) assert(seen[i] == 1);
+    assert(mpmcGetSize(shared_q) == 0);
+    freeMpmcQueue(shared_q);
+    printf("MPMC stress test passed (%d producers, %d consumers, %d vehicles)!\n",
+           PRODUCERS, CONSUMERS, TOTAL);
+}
+
+int main() {
+    test_mpmc_basic();
+    test_mpmc_stress();
+    return 0;
+}
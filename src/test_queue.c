@@ -7,7 +7,7 @@ void test_queue() {
     assert(isEmpty(q));
     assert(getSize(q) == 0);
 
-    Vehicle v1 = {1};
+    Vehicle v1 = {.id = 1};
     enqueue(q, v1);
     assert(!isEmpty(q));
     assert(getSize(q) == 1);
@@ -20,7 +20,91 @@ void test_queue() {
     printf("Queue tests passed!\n");
 }
 
+void test_queue_wraparound() {
+    Queue* q = createQueue();
+    int next_in = 0, next_out = 0;
+
+    // Keep the ring partly full so head wraps before every growth
+    for (int round = 0; round < 200; round++) {
+        for (int i = 0; i < 7; i++) {
+            Vehicle v = {.id = next_in++};
+            enqueue(q, v);
+        }
+        for (int i = 0; i < 5; i++) {
+            Vehicle v = dequeue(q);
+            assert(v.id == next_out++);
+        }
+        assert(getSize(q) == next_in - next_out);
+    }
+    assert(q->capacity >= getSize(q));
+    assert((q->capacity & (q->capacity - 1)) == 0);
+
+    while (!isEmpty(q)) {
+        Vehicle v = dequeue(q);
+        assert(v.id == next_out++);
+    }
+    assert(next_out == next_in);
+
+    freeQueue(q);
+    printf("Queue wraparound tests passed!\n");
+}
+
+void test_queue_stats() {
+    Queue* q = createQueue();
+    for (int i = 0; i < 40; i++) {
+        Vehicle v = {.id = i};
+        enqueue(q, v);
+    }
+    for (int i = 0; i < 40; i++) dequeue(q);
+    for (int i = 0; i < 60; i++) {
+        Vehicle v = {.id = i};
+        enqueue(q, v);
+        dequeue(q);
+    }
+
+    QueueStats s = getQueueStats(q);
+    assert(s.high_water == 40);
+    assert(s.capacity == 64);
+    assert(s.allocations == 3); // 16 -> 32 -> 64
+    assert(s.enqueued == 100);
+    assert(s.reuse_ratio > 0.59 && s.reuse_ratio < 0.61);
+
+    freeQueue(q);
+    printf("Queue stats tests passed!\n");
+}
+
+void test_queue_batch() {
+    Queue* q = createQueue();
+    Vehicle in[100], out[100];
+    for (int i = 0; i < 100; i++) in[i].id = i;
+
+    // Offset the head so batches straddle the end of the ring
+    enqueueBatch(q, in, 10);
+    assert(dequeueBatch(q, out, 10) == 10);
+    for (int i = 0; i < 10; i++) assert(out[i].id == i);
+
+    enqueueBatch(q, in, 12);
+    assert(getSize(q) == 12);
+    enqueueBatch(q, in + 12, 88); // forces growth while wrapped
+    assert(getSize(q) == 100);
+
+    assert(dequeueBatch(q, out, 30) == 30);
+    assert(dequeueBatch(q, out + 30, 1000) == 70);
+    for (int i = 0; i < 100; i++) assert(out[i].id == i);
+    assert(isEmpty(q));
+    assert(dequeueBatch(q, out, 5) == 0);
+
+    enqueueBatch(q, in, 0);
+    assert(isEmpty(q));
+
+    freeQueue(q);
+    printf("Queue batch tests passed!\n");
+}
+
 int main() {
     test_queue();
+    test_queue_wraparound();
+    test_queue_stats();
+    test_queue_batch();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include "spsc_queue.h"
+#include "report_queue.h"
+
+#define STRESS_VEHICLES 5000000
+#define STRESS_CAPACITY 256   // small ring so both sides keep colliding
+
+void test_spsc_basic() {
+    SpscQueue* q = createSpscQueue(3); // rounds up to 4
+    Vehicle v;
+    assert(!spscDequeue(q, &v));
+    for (int i = 0; i < 4; i++) {
+        Vehicle in = {.id = i};
+        assert(spscEnqueue(q, in));
+    }
+    Vehicle extra = {.id = 99};
+    assert(!spscEnqueue(q, extra));
+    assert(spscGetSize(q) == 4);
+
+    assert(spscDequeue(q, &v) && v.id == 0);
+    assert(spscEnqueue(q, extra));
+
+    Vehicle out[8];
+    assert(spscDequeueBatch(q, out, 8) == 4);
+    assert(out[0].id == 1 && out[1].id == 2 && out[2].id == 3 && out[3].id == 99);
+    assert(spscGetSize(q) == 0);
+
+    freeSpscQueue(q);
+    printf("SPSC basic tests passed!\n");
+}
+
+static void* producer(void* arg) {
+    SpscQueue* q = (SpscQueue*)arg;
+    for (int i = 0; i < STRESS_VEHICLES; i++) {
+        Vehicle v = {.id = i};
+        while (!spscEnqueue(q, v)) {
+            sched_yield(); // ring full: let the consumer catch up
+        }
+    }
+    return NULL;
+}
+
+void test_spsc_stress() {
+    SpscQueue* q = createSpscQueue(STRESS_CAPACITY);
+    pthread_t thread;
+    pthread_create(&thread, NULL, producer, q);
+
+    // Consumer: mix single and batch dequeues; every id must arrive once, in order
+    int expected = 0;
+    Vehicle out[32];
+    while (expected < STRESS_VEHICLES) {
+        if (expected % 3 == 0) {
+            Vehicle v;
+            if (spscDequeue(q, &v)) {
+                assert(v.id == expected);
+                expected++;
+            } else {
+                sched_yield();
+            }
+        } else {
+            int n = spscDequeueBatch(q, out, 32);
+            if (n == 0) sched_yield();
+            for (int i = 0; i < n; i++) {
+                assert(out[i].id == expected);
+                expected++;
+            }
+        }
+    }
+    pthread_join(thread, NULL);
+
+    Vehicle v;
+    assert(!spscDequeue(q, &v));
+    freeSpscQueue(q);
+    printf("SPSC stress test passed (%d vehicles, FIFO, no loss)!\n", STRESS_VEHICLES);
+}
+
+static void* report_producer(void* arg) {
+    ReportQueue* q = (ReportQueue*)arg;
+    for (int i = 0; i < STRESS_VEHICLES / 10; i++) {
+        Report r = {.type = REPORT_PASSED, .time_ms = (unsigned int)i, .lane = i & 3};
+        while (!reportEnqueue(q, &r)) sched_yield();
+    }
+    return NULL;
+}
+
+// The scheduler -> reporter ring follows the same protocol with larger records
+void test_report_queue() {
+    ReportQueue* q = createReportQueue(STRESS_CAPACITY);
+    Report r;
+    assert(!reportDequeue(q, &r));
+    pthread_t thread;
+    pthread_create(&thread, NULL, report_producer, q);
+    for (int i = 0; i < STRESS_VEHICLES / 10; i++) {
+        while (!reportDequeue(q, &r)) sched_yield();
+        assert(r.type == REPORT_PASSED && r.time_ms == (unsigned int)i && r.lane == (i & 3));
+    }
+    pthread_join(thread, NULL);
+    assert(!reportDequeue(q, &r));
+    freeReportQueue(q);
+    printf("Report queue stress test passed!\n");
+}
+
+int main() {
+    test_spsc_basic();
+    test_spsc_stress();
+    test_report_queue();
+    return 0;
+}
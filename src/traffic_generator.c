@@ -1,93 +1,68 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
-#ifndef _WIN32
-#include <unistd.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
-#endif
 
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#include <windows.h>
-#pragma comment(lib, "ws2_32.lib")
-#define sleep(x) Sleep(x * 1000)
-#endif
+#include "arrivals.h"
+#include "arrival_sink.h"
 
-#define NUM_LANES 4
 #define INITIAL_VEHICLES 5
-#define BASE_INTERVAL 2
-#define PRIORITY_BOOST 1
+#define DEFAULT_SEED 1
 
-const char* lane_files[NUM_LANES] = {
-    "data/lanea.txt",
-    "data/laneb.txt",
-    "data/lanec.txt",
-    "data/laned.txt"
-};
+// One vehicle every ~3 s in total, lane A (AL2) a little busier than the rest
+static const double default_rates[NUM_LANES] = {0.108, 0.075, 0.075, 0.075};
 
-int main() {
-    srand(time(NULL));
-    int vehicle_id = 1;
-
-#ifdef _WIN32
-    WSADATA wsa;
-    WSAStartup(MAKEWORD(2,2), &wsa);
-#endif
-
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    struct sockaddr_in server_addr;
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(8080);
-    inet_pton(AF_INET, "127.0.0.1", &server_addr.sin_addr);
-
-    if (connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        perror("Connect failed");
+int main(int argc, char* argv[]) {
+    ArrivalOptions opts;
+    defaultArrivalConfig(&opts.cfg, ARRIVAL_POISSON, 0);
+    memcpy(opts.cfg.rate, default_rates, sizeof(default_rates));
+    opts.seed = DEFAULT_SEED;
+    opts.flush_ms = LANE_FLUSH_MS;
+    opts.host = ARRIVAL_SINK_HOST;
+    opts.port = ARRIVAL_SINK_PORT;
+    if (parseArrivalOptions(argc, argv, &opts)) {
+        printArrivalUsage(argv[0]);
         return 1;
     }
+    int vehicle_id = 1;
 
-    printf("Connected to simulator.\n");
+    ArrivalSink sink;
+    if (openArrivalSink(&sink, &opts, 1)) return 1;
 
-    // Generate initial vehicles
+    // Generate initial vehicles (the lane files start empty)
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    WireArrival initial[NUM_LANES * INITIAL_VEHICLES];
+    int n = 0;
     for (int i = 0; i < NUM_LANES; i++) {
-        FILE* fp = fopen(lane_files[i], "w");
-        if (fp == NULL) {
-            perror("Error opening file");
-            return 1;
-        }
         for (int j = 0; j < INITIAL_VEHICLES; j++) {
-            fprintf(fp, "%d\n", vehicle_id++);
+            WireArrival* a = &initial[n++];
+            memset(a, 0, sizeof(*a)); // intent 0: straight
+            a->id = (unsigned int)vehicle_id++;
+            a->lane = (unsigned char)i;
         }
-        fclose(fp);
     }
+    if (arrivalSinkSend(&sink, initial, n) || flushArrivalSink(&sink)) return 1;
 
     printf("Initial vehicles generated.\n");
 
-    // Continuously generate more vehicles with varying rates
-    while (1) {
-        int lane = rand() % NUM_LANES;
-        if (lane != 0 && rand() % 10 < PRIORITY_BOOST) {
-            lane = 0;
-        }
-        FILE* fp = fopen(lane_files[lane], "a");
-        if (fp == NULL) {
-            perror("Error opening file");
-            return 1;
-        }
-        fprintf(fp, "%d\n", vehicle_id++);
-        fclose(fp);
-        printf("Added vehicle %d to lane %c\n", vehicle_id - 1, 'A' + lane);
-
-        // Socket: Send message
-        char msg[50];
-        sprintf(msg, "Vehicle %d to lane %c\n", vehicle_id - 1, 'A' + lane);
-        send(sock, msg, strlen(msg), 0);
+    // Then one vehicle at a time, as the arrival model schedules them
+    ArrivalGen gen;
+    initArrivalGen(&gen, &opts.cfg, opts.seed, vehicle_id);
+    printf("Arrival model: %s, seed %llu\n", arrivalModelName(opts.cfg.model), (unsigned long long)opts.seed);
+    unsigned int at;
+    while (peekArrival(&gen, &at)) {
+        arrivalSleepUntil(&start, at);
+        WireArrival arrival;
+        takeArrivals(&gen, at + 1, &arrival, 1);
+        if (arrivalSinkSend(&sink, &arrival, 1)) return 1;
+        printf("Added vehicle %u to lane %c\n", arrival.id, 'A' + arrival.lane);
 
-        int sleep_time = BASE_INTERVAL + (rand() % 3);
-        sleep(sleep_time);
+        unsigned int next = at;
+        if (!peekArrival(&gen, &next)) break;
+        if (arrivalSinkFlushDue(&sink, at, next)) return 1;
     }
 
+    closeArrivalSink(&sink);
     return 0;
 }
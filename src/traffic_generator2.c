@@ -1,45 +1,47 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
-#ifndef _WIN32
-#include <unistd.h>
-#endif
 
-#ifdef _WIN32
-#include <windows.h>
-#define sleep(x) Sleep(x * 1000)
-#endif
+#include "arrivals.h"
+#include "arrival_sink.h"
 
-#define NUM_LANES 4
-#define BURST_SIZE 5
+#define DEFAULT_SEED 2
+#define TICK_MS 1000   // send whatever is due once a second
 
-const char* lane_files[NUM_LANES] = {
-    "data/lanea.txt",
-    "data/laneb.txt",
-    "data/lanec.txt",
-    "data/laned.txt"
-};
-
-int main() {
-    srand(time(NULL));
-    int vehicle_id = 1000; // Different ID range
+int main(int argc, char* argv[]) {
+    ArrivalOptions opts;
+    defaultArrivalConfig(&opts.cfg, ARRIVAL_MMPP, 0.16); // about 1 vehicle/s overall, in bursts
+    opts.seed = DEFAULT_SEED;
+    opts.flush_ms = LANE_FLUSH_MS;
+    opts.host = ARRIVAL_SINK_HOST;
+    opts.port = ARRIVAL_SINK_PORT;
+    if (parseArrivalOptions(argc, argv, &opts)) {
+        printArrivalUsage(argv[0]);
+        return 1;
+    }
+    ArrivalGen gen;
+    initArrivalGen(&gen, &opts.cfg, opts.seed, 1000); // Different ID range
 
-    printf("Traffic Generator 2: Burst mode started.\n");
+    ArrivalSink sink;
+    if (openArrivalSink(&sink, &opts, 0)) return 1;
+    printf("Traffic Generator 2: Burst mode started (%s, seed %llu)\n", arrivalModelName(opts.cfg.model), (unsigned long long)opts.seed);
 
-    while (1) {
-        int lane = rand() % NUM_LANES;
-        FILE* fp = fopen(lane_files[lane], "a");
-        if (fp == NULL) {
-            perror("Error opening file");
-            return 1;
-        }
-        for (int b = 0; b < BURST_SIZE; b++) {
-            fprintf(fp, "%d\n", vehicle_id++);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    unsigned int at;
+    for (unsigned int tick = TICK_MS; peekArrival(&gen, &at); tick += TICK_MS) {
+        arrivalSleepUntil(&start, tick);
+        // Everything due this second goes to the simulator as one binary frame
+        WireArrival batch[WIRE_MAX_BATCH];
+        int n;
+        while ((n = takeArrivals(&gen, tick, batch, WIRE_MAX_BATCH)) > 0) {
+            if (arrivalSinkSend(&sink, batch, n)) return 1;
+            printf("Burst: Added %d vehicles (ID %u-%u)\n", n, batch[0].id, batch[n - 1].id);
         }
-        fclose(fp);
-        printf("Burst: Added %d vehicles to lane %c (ID %d-%d)\n", BURST_SIZE, 'A' + lane, vehicle_id - BURST_SIZE, vehicle_id - 1);
-        sleep(5); // Burst every 5 seconds
+        if (arrivalSinkFlushDue(&sink, tick, tick + TICK_MS)) return 1;
     }
 
+    closeArrivalSink(&sink);
     return 0;
 }
@@ -0,0 +1,63 @@
+#include "wait_stats.h"
+#include <string.h>
+
+// Bucket index: exact for small values, otherwise (exponent, top bits)
+static int bucketFor(unsigned int ms) {
+    if (ms < WAIT_SUB_BUCKETS) return (int)ms;
+    int msb = 31 - __builtin_clz(ms);
+    int shift = msb - WAIT_SUB_BITS;
+    return (shift + 1) * WAIT_SUB_BUCKETS + (int)((ms >> shift) - WAIT_SUB_BUCKETS);
+}
+
+// Largest value that falls into a bucket
+static unsigned int bucketUpperBound(int bucket) {
+    if (bucket < WAIT_SUB_BUCKETS) return (unsigned int)bucket;
+    int shift = bucket / WAIT_SUB_BUCKETS - 1;
+    unsigned long long base = (unsigned long long)(bucket % WAIT_SUB_BUCKETS + WAIT_SUB_BUCKETS) << shift;
+    return (unsigned int)(base + ((1ULL << shift) - 1));
+}
+
+void initWaitHistogram(WaitHistogram* h) {
+    memset(h, 0, sizeof(*h));
+}
+
+void recordWait(WaitHistogram* h, unsigned int wait_ms) {
+    h->counts[bucketFor(wait_ms)]++;
+    h->count++;
+    h->total_ms += wait_ms;
+    if (wait_ms > h->max_ms) h->max_ms = wait_ms;
+}
+
+// Record a served vehicle's time from arrival to departure
+void recordDeparture(WaitHistogram* h, const Vehicle* v) {
+    recordWait(h, v->departure_ms >= v->arrival_ms ? v->departure_ms - v->arrival_ms : 0);
+}
+
+// Wait time (upper bucket bound, capped at the observed max) at or below
+// which a fraction p of the recorded vehicles fall
+unsigned int waitPercentile(const WaitHistogram* h, double p) {
+    if (h->count == 0) return 0;
+    unsigned long rank = (unsigned long)(p * h->count + 0.5);
+    if (rank < 1) rank = 1;
+    unsigned long seen = 0;
+    for (int b = 0; b < WAIT_BUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen >= rank) {
+            unsigned int bound = bucketUpperBound(b);
+            return bound < h->max_ms ? bound : h->max_ms;
+        }
+    }
+    return h->max_ms;
+}
+
+double waitMean(const WaitHistogram* h) {
+    return h->count ? (double)h->total_ms / h->count : 0.0;
+}
+
+// Add another histogram's samples (e.g. one per worker thread) into this one
+void mergeWaitHistogram(WaitHistogram* into, const WaitHistogram* from) {
+    for (int b = 0; b < WAIT_BUCKETS; b++) into->counts[b] += from->counts[b];
+    into->count += from->count;
+    into->total_ms += from->total_ms;
+    if (from->max_ms > into->max_ms) into->max_ms = from->max_ms;
+}
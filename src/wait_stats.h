@@ -0,0 +1,30 @@
+#ifndef WAIT_STATS_H
+#define WAIT_STATS_H
+
+#include "queue.h"
+
+// Log-linear histogram of vehicle wait times (milliseconds).
+// Values below 2^WAIT_SUB_BITS ms are counted exactly; above that each
+// power of two is split into 2^WAIT_SUB_BITS buckets, so percentiles are
+// accurate to ~3% with a fixed ~3.5 KB per lane (896 4-byte counters) no
+// matter how many vehicles pass.
+#define WAIT_SUB_BITS 5
+#define WAIT_SUB_BUCKETS (1 << WAIT_SUB_BITS)
+#define WAIT_BUCKETS ((32 - WAIT_SUB_BITS + 1) * WAIT_SUB_BUCKETS)
+
+typedef struct {
+    unsigned int counts[WAIT_BUCKETS];
+    unsigned long count;
+    unsigned long long total_ms;
+    unsigned int max_ms;
+} WaitHistogram;
+
+// Function prototypes
+void initWaitHistogram(WaitHistogram* h);
+void recordWait(WaitHistogram* h, unsigned int wait_ms);
+void recordDeparture(WaitHistogram* h, const Vehicle* v);
+unsigned int waitPercentile(const WaitHistogram* h, double p);
+double waitMean(const WaitHistogram* h);
+void mergeWaitHistogram(WaitHistogram* into, const WaitHistogram* from);
+
+#endif // WAIT_STATS_H
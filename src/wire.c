@@ -0,0 +1,75 @@
+#include "wire.h"
+#include <stdio.h>
+#include <string.h>
+#include "queue.h"
+
+static void put32(unsigned char* p, unsigned int v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static unsigned int get32(const unsigned char* p) {
+    return (unsigned int)p[0] | (unsigned int)p[1] << 8 | (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24;
+}
+
+// Encode up to WIRE_MAX_BATCH arrivals as one frame into out (which must
+// hold WIRE_MAX_FRAME bytes). Returns the frame size in bytes.
+int wireEncodeFrame(unsigned char* out, const WireArrival* arrivals, int count) {
+    if (count > WIRE_MAX_BATCH) count = WIRE_MAX_BATCH;
+    out[0] = WIRE_MAGIC;
+    out[1] = WIRE_VERSION;
+    out[2] = WIRE_FRAME_ARRIVALS;
+    out[3] = 0;
+    put32(out + 4, (unsigned int)(count * WIRE_ARRIVAL_SIZE));
+    unsigned char* p = out + WIRE_HEADER_SIZE;
+    for (int i = 0; i < count; i++, p += WIRE_ARRIVAL_SIZE) {
+        put32(p, arrivals[i].id);
+        p[4] = arrivals[i].lane;
+        p[5] = arrivals[i].intent;
+        p[6] = p[7] = 0;
+    }
+    return WIRE_HEADER_SIZE + count * WIRE_ARRIVAL_SIZE;
+}
+
+// Decode one frame from the start of buf into out (WIRE_MAX_BATCH slots).
+// Returns the number of arrivals and sets *consumed to the frame size,
+// 0 with *consumed = 0 if the frame is not complete yet, or -1 if the
+// bytes are not a frame this version understands.
+int wireDecodeFrame(const unsigned char* buf, int len, WireArrival* out, int* consumed) {
+    *consumed = 0;
+    if (len < WIRE_HEADER_SIZE) return 0;
+    if (buf[0] != WIRE_MAGIC || buf[1] != WIRE_VERSION || buf[2] != WIRE_FRAME_ARRIVALS) return -1;
+    unsigned int payload = get32(buf + 4);
+    if (payload % WIRE_ARRIVAL_SIZE != 0 || payload > WIRE_MAX_BATCH * WIRE_ARRIVAL_SIZE) return -1;
+    if ((unsigned int)len < WIRE_HEADER_SIZE + payload) return 0;
+
+    int count = (int)(payload / WIRE_ARRIVAL_SIZE);
+    const unsigned char* p = buf + WIRE_HEADER_SIZE;
+    for (int i = 0; i < count; i++, p += WIRE_ARRIVAL_SIZE) {
+        out[i].id = get32(p);
+        out[i].lane = p[4];
+        out[i].intent = p[5];
+    }
+    *consumed = WIRE_HEADER_SIZE + (int)payload;
+    return count;
+}
+
+// Format one arrival as a text line; returns its length
+int wireFormatText(char* out, int cap, const WireArrival* a) {
+    char turn = a->intent == INTENT_LEFT ? 'L' : a->intent == INTENT_RIGHT ? 'R' : 'S';
+    return snprintf(out, cap, "Vehicle %u to lane %c %c\n", a->id, 'A' + a->lane, turn);
+}
+
+// Parse one text line (without its newline); returns 1 for a valid arrival
+int wireParseText(const char* line, int num_lanes, WireArrival* a) {
+    int id;
+    char lane, turn = 'S';
+    if (sscanf(line, "Vehicle %d to lane %c %c", &id, &lane, &turn) < 2) return 0;
+    if (lane < 'A' || lane >= 'A' + num_lanes) return 0;
+    a->id = (unsigned int)id;
+    a->lane = (unsigned char)(lane - 'A');
+    a->intent = turn == 'L' ? INTENT_LEFT : turn == 'R' ? INTENT_RIGHT : INTENT_STRAIGHT;
+    return 1;
+}
@@ -0,0 +1,44 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+// Generator -> simulator wire formats.
+//
+// Text (one arrival per line, human readable):
+//     Vehicle <id> to lane <A-D> [L|S|R]\n
+//
+// Binary (batched, little-endian). Every frame starts with an 8-byte header
+//     byte 0     WIRE_MAGIC (0xB5, never the first byte of a text line)
+//     byte 1     WIRE_VERSION
+//     byte 2     frame type (WIRE_FRAME_ARRIVALS)
+//     byte 3     reserved, 0
+//     bytes 4-7  payload length in bytes (count * WIRE_ARRIVAL_SIZE)
+// followed by the arrival records, WIRE_ARRIVAL_SIZE bytes each
+//     bytes 0-3  vehicle id
+//     byte 4     lane index (0 = A)
+//     byte 5     intent (TurnIntent)
+//     bytes 6-7  reserved, 0
+// A connection may mix both formats frame by frame. Arrival times are not
+// sent: the simulator stamps arrivals with its own clock when they land.
+
+#define WIRE_MAGIC 0xB5
+#define WIRE_VERSION 2
+#define WIRE_FRAME_ARRIVALS 1
+#define WIRE_HEADER_SIZE 8
+#define WIRE_ARRIVAL_SIZE 8
+#define WIRE_MAX_BATCH 256
+#define WIRE_MAX_FRAME (WIRE_HEADER_SIZE + WIRE_MAX_BATCH * WIRE_ARRIVAL_SIZE)
+
+// One arrival record, exactly the fields encoded above
+typedef struct {
+    unsigned int id;
+    unsigned char lane;
+    unsigned char intent;
+} WireArrival;
+
+// Function prototypes
+int wireEncodeFrame(unsigned char* out, const WireArrival* arrivals, int count);
+int wireDecodeFrame(const unsigned char* buf, int len, WireArrival* out, int* consumed);
+int wireFormatText(char* out, int cap, const WireArrival* a);
+int wireParseText(const char* line, int num_lanes, WireArrival* a);
+
+#endif // WIRE_H
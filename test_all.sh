@@ -7,5 +7,9 @@ make
 echo "Running tests..."
 ./test_queue
 ./test_integration
+./test_spsc
+./test_mpmc
+./simulator --fast --seed 7 --duration 3600 --adaptive --quiet --record /tmp/test_all.trc > /dev/null
+./simulator --replay /tmp/test_all.trc || echo "Replay test FAILED"
 
 echo "Tests completed. Check simulation_log.txt for logs."
\ No newline at end of file